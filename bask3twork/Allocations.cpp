@@ -0,0 +1,52 @@
+#include "pch.h"
+#include "Allocations.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _DEBUG
+
+namespace
+{
+	thread_local std::size_t allocations = 0;
+}
+
+std::size_t allocation_count()
+{
+	return allocations;
+}
+
+/// The global allocation functions are replaced so that each allocation is counted, and otherwise behave as the defaults,
+/// calling the new-handler until the allocation succeeds, or throwing \c std::bad_alloc if there is none.
+/// The default array and \c nothrow forms call these, so they are counted too.
+void* operator new(std::size_t size)
+{
+	++allocations;
+	while (true)
+	{
+		if (void* pointer = std::malloc(size == 0 ? 1 : size))
+			return pointer;
+		const std::new_handler handler = std::get_new_handler();
+		if (!handler)
+			throw std::bad_alloc();
+		handler();
+	}
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+#else
+
+std::size_t allocation_count()
+{
+	return 0;
+}
+
+#endif
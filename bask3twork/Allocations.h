@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+/// \file
+
+/// The number of allocations made through the global \c operator \c new so far by the calling thread, so that a loop can be checked not to allocate by comparing it before and after.
+/// Allocations are only counted in debug builds, where the global allocation functions are replaced, and this is always \c 0 otherwise.
+std::size_t allocation_count();
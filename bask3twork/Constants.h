@@ -2,6 +2,7 @@
 #include <wx/colour.h>
 #include <wx/font.h>
 #include <array>
+#include <chrono>
 /// \file
 
 namespace Limits
@@ -62,8 +63,27 @@ namespace Fonts
 }
 
 // Constants for the iterations of knot generating
-constexpr int MAX_ATTEMPTS = 10000;				///< The maximum number of attempts for the Knot to try generating
+constexpr std::chrono::seconds GENERATE_TIME_BUDGET{ 20 }; ///< How long the Knot keeps trying to generate before giving up, whatever the method, see Knot::time_budget
 constexpr int ATTEMPTS_DISPLAY_INCREMENT = 500;	///< The interval at which the number of iterations is displayed
+constexpr std::chrono::milliseconds PARALLEL_DISPLAY_INTERVAL{ 50 }; ///< The interval at which the combined number of attempts is displayed while several threads are generating
+constexpr int FEASIBILITY_BACKTRACKS = 1000;	///< The number of dead ends after which checking whether a knot can be generated at all gives up
+constexpr std::chrono::milliseconds FEASIBILITY_TIME_BUDGET{ 5 }; ///< How long each search made while checking whether a knot can be generated at all keeps going before giving up
+constexpr int FIRST_RUN_BACKTRACKS = 100;		///< The number of dead ends after which the first run of the backtracking search starts over, and the unit of every later cutoff, see \c RestartSchedule
+constexpr int DIVIDE_BLOCK_SIZE = 32;			///< About the number of tiles along each side of the blocks which dividing generates in parallel
+constexpr int DIVIDE_SEAM_WIDTH = 2;			///< The width in tiles of the seams left between blocks, which are generated once the blocks are done
+constexpr int DIVIDE_REGION_BACKTRACKS = 10000;	///< The number of dead ends after which dividing gives up on a region, and tries it again, see Knot::generate_dividing()
+constexpr int TRANSFER_MAX_STATES = 1 << 14;	///< The most boundaries which uniform sampling counts at any one step, beyond which the selection is too wide for it
+constexpr std::chrono::seconds COUNT_TIME_BUDGET{ 2 };   ///< How long counting lists the knots of each symmetry one at a time, when the selection is too wide to count them all at once
+constexpr std::size_t PATCH_CACHE_BYTES = 32 << 20;	///< The most memory which the patches kept for rerolling take up, see PatchCache
+constexpr int PATCH_CACHE_VARIANTS = 32;		///< The most patches kept for selections of the same size, symmetry and surroundings
+constexpr int PATCH_WARM_MAX_SIZE = 5;			///< The largest windows of an opened knot which are kept as patches, in tiles along each side
+constexpr int PATCH_WARM_MAX_WINDOWS = 1 << 16;	///< The most windows of an opened knot which are looked at to be kept as patches
+constexpr int PARTIAL_RESTARTS = 4;			///< The number of times an attempt at propagation starts over only around where it failed, before starting over from scratch
+constexpr int PARTIAL_RESTART_RADIUS = 3;		///< How many edges away from where an attempt failed its first partial restart clears, growing by this much for each one after
+constexpr int REPAIR_WALK_ONE_IN = 10;			///< Local repair picks a random glyph rather than the best one for one in this many repairs
+constexpr std::size_t ORBIT_TABLE_CACHE_ENTRIES = 32;	///< The most sizes and symmetries of selection whose orbits are kept, see \c OrbitTable
+constexpr std::size_t ALIAS_CACHE_ENTRIES = 256;	///< The slots of alias tables which each thread keeps for choosing glyphs by weight, see \c GlyphWeights
+constexpr int STYLE_GLYPH_COLUMNS = 9;	///< The columns of a line of "All Glyphs.csv", which a line of a style profile may repeat before its weight, see File::read_style()
 
 namespace Borders
 {
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "File.h"
 #include "pure/Glyph.h"
+#include "pure/GlyphGrid.h"
+#include "pure/GlyphWeights.h"
 #include "pure/GridSize.h"
 #include "grid/Display.h"
 #include "grid/Knot.h"
@@ -88,17 +90,14 @@ auto File::read(const wxString& file_name)
 
 
 
-	Glyphs glyphs;
-	glyphs.reserve(size.rows);
+	Glyphs glyphs(size);
 
 	std::size_t running_index = 0;
 	for (int i = 0; i < size.rows; ++i)
 	{
-		auto& row = glyphs.emplace_back();
-		row.reserve(size.columns);
-		for (int j = 0; j < size.columns; ++j)
+		for (std::uint8_t& index : glyphs.row(i))
 		{
-			row.push_back(UnicharToGlyph.at(code_points[running_index++]));
+			index = GlyphGrid::encode(UnicharToGlyph.at(code_points[running_index++]));
 		}
 	}
 
@@ -108,6 +107,52 @@ auto File::read(const wxString& file_name)
 }
 
 
+std::optional<GlyphWeights> File::read_style(const wxString& file_name)
+/** Reads a style profile, which has a line for each glyph to weight, holding its code point and its weight separated by a comma.
+ * A line may instead be a line of \c "All Glyphs.csv", starting with the code point, with the weight added as a last column,
+ * so that a copy of that file can be weighted in place.
+ * Blank lines, and anything after a \c #, are ignored. Every glyph not listed keeps a weight of \c 1.
+ */
+{
+	wxTextFile file;
+	if (!file.Open(file_name))
+	{
+		wxMessageBox("Failed to open file.", "Error");
+		return std::nullopt;
+	}
+
+	GlyphWeights weights;
+	for (std::size_t line_number = 0; line_number < file.GetLineCount(); ++line_number)
+	{
+		const wxString line = file.GetLine(line_number).BeforeFirst('#').Trim().Trim(false);
+		if (line.IsEmpty())
+			continue;
+
+		const int commas = line.Freq(',');
+		long code_point;
+		double weight;
+		if ((commas != 1 && commas != STYLE_GLYPH_COLUMNS) || !line.BeforeFirst(',').Trim().ToLong(&code_point) || !line.AfterLast(',').Trim(false).ToCDouble(&weight))
+		{
+			wxMessageBox(wxString::Format("Line %zu should be a code point and a weight, or a line of \"All Glyphs.csv\" followed by a weight, separated by commas.", line_number + 1), "Error");
+			return std::nullopt;
+		}
+		const auto glyph = UnicharToGlyph.find(static_cast<CodePoint>(code_point));
+		if (glyph == UnicharToGlyph.end())
+		{
+			wxMessageBox(wxString::Format("Line %zu has unsupported code point %li.", line_number + 1, code_point), "Error");
+			return std::nullopt;
+		}
+		if (!std::isfinite(weight) || weight < 0)
+		{
+			wxMessageBox(wxString::Format("Line %zu has a weight which is not a number from 0 upwards.", line_number + 1), "Error");
+			return std::nullopt;
+		}
+		weights.set(index_of(glyph->second), weight);
+	}
+	return weights;
+}
+
+
 
 std::size_t File::file_size(GridSize size)
 {
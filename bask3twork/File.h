@@ -15,7 +15,10 @@ public:
 	static auto read(const wxString& file_name)
 		-> std::optional<std::tuple<GridSize, Glyphs, std::vector<Bool>>>;
 
+	static std::optional<GlyphWeights> read_style(const wxString& file_name);
+
 	static constexpr const char* ext = "Bask3twork Knot Files (*.k3knot)|*.k3knot";
+	static constexpr const char* style_ext = "Bask3twork Style Files (*.csv)|*.csv";
 
 private:
 	static std::size_t file_size(GridSize size);
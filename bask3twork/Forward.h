@@ -31,7 +31,9 @@ class RegenDialogTextBox;
 
 // Grid
 class DisplayGrid;
+enum class GenerationMethod;
 class Knot;
+class PatchCache;
 
 enum class TileLocked : bool;
 enum class TileHighlighted : bool;
@@ -49,15 +51,28 @@ struct Connections;
 
 enum class GlyphFlag;
 struct Glyph;
-using Glyphs = std::vector<std::vector<const Glyph*>>;
+class GlyphGrid;
+using Glyphs = GlyphGrid;
 struct GlyphsTransformed;
+class GlyphSet;
+class GlyphWeights;
+enum class Transform : uint8_t;
 using CodePoint = int32_t;
 
 struct GridSize;
 
+enum class Repeat;
+struct Pattern;
+
+struct OrbitImage;
+class OrbitTable;
+
 struct Point;
 struct Selection;
 
+class Xoshiro256;
+using Rng = Xoshiro256;
+
 class SelectionIterator;
 class SelectionZipIterator;
 class SelectionZipRange;
@@ -71,3 +86,19 @@ class SymmetryChecker;
 class GenerateRegion;
 class GenerateRegionButton;
 class LockingRegion;
+
+
+
+// Solver
+class Backtracker;
+enum class Feasibility;
+struct FeasibilityReport;
+class Problem;
+struct ProblemCell;
+struct ProblemEdge;
+enum class RequirementSource;
+struct ProblemRequirement;
+class Propagator;
+class Repairer;
+struct SolutionCount;
+class StripSampler;
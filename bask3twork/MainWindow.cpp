@@ -4,17 +4,28 @@
 #include "MainWindow.h"
 #include "grid/Display.h"
 #include "grid/Knot.h"
+#include "grid/PatchCache.h"
 #include "grid/Tile.h"
 #include "pure/Glyph.h"
+#include "pure/GlyphWeights.h"
 #include "pure/GridSize.h"
 #include "pure/Symmetry.h"
 #include "pure/UsableEnum.h"
 #include "regions/Generate.h"
 #include "regions/Locking.h"
+#include "solver/Enumeration.h"
+#include "solver/Feasibility.h"
 #include "controls/ExportDialog.h"
 #include "controls/MenuBar.h"
 #include "controls/RegenDialog.h"
 
+namespace
+{
+	wxDEFINE_EVENT(GENERATION_PROGRESS, wxThreadEvent); ///< Posted by the generating thread with the status to show, see Knot::Progress
+	wxDEFINE_EVENT(GENERATION_FINISHED, wxThreadEvent); ///< Posted by the generating thread once it is done, with the new glyphs as its payload if it succeeded
+	wxDEFINE_EVENT(COUNTING_FINISHED, wxThreadEvent);   ///< Posted by the generating thread once it has counted knots, with the message listing the counts
+}
+
 MainWindow::MainWindow(GridSize size, wxString title)
 	: wxFrame(nullptr, wxID_ANY, title)
 	, size(size)
@@ -27,47 +38,64 @@ MainWindow::MainWindow(GridSize size, wxString title)
 	, menu_bar(new MenuBar(this))
 
 	, disp(new DisplayGrid(this, size))
-	, knot(new Knot(size, CreateStatusBar()))
+	, knot(new Knot(size))
+	, patches(std::make_shared<PatchCache>())
 	, grid_sizer(make_grid_sizer(disp))
 
 	, main_sizer(make_main_sizer(grid_sizer, region_sizer))
 {
+	CreateStatusBar();
 	Bind(wxEVT_CHAR_HOOK, &MainWindow::on_key_press, this);
+	Bind(GENERATION_PROGRESS, &MainWindow::on_generation_progress, this);
+	Bind(GENERATION_FINISHED, &MainWindow::on_generation_finished, this);
+	Bind(COUNTING_FINISHED, &MainWindow::on_counting_finished, this);
 	SetBackgroundColour(Colours::background);
 	SetSizer(main_sizer);
+	update_patch_reuse();
 	update_sizing();
 }
 MainWindow::~MainWindow()
 {
 	Hide();
+	abandon_generating();
 }
 
 void MainWindow::lock_selection(wxCommandEvent& evt)
 {
 	disp->lock();
-	generate_region->enable_buttons(current_symmetry());
+	knot->locking_changed();
+	update_generate_buttons();
 	evt.Skip();
 }
 
 void MainWindow::unlock_selection(wxCommandEvent& evt)
 {
 	disp->unlock();
-	generate_region->enable_buttons(current_symmetry());
+	knot->locking_changed();
+	update_generate_buttons();
 	evt.Skip();
 }
 
 void MainWindow::invert_locking(wxCommandEvent& evt)
 {
 	disp->invert_locking();
-	generate_region->enable_buttons(current_symmetry());
+	knot->locking_changed();
+	update_generate_buttons();
 	evt.Skip();
 }
 
+void MainWindow::lock_changed(Point point)
+{
+	knot->lock_changed(point, disp->get_tiles());
+	if (buttons_enabled)
+		update_generate_buttons();
+}
+
 void MainWindow::enable_buttons()
 {
 	buttons_enabled = true;
 	locking_region->enable_buttons();
-	generate_region->enable_buttons(current_symmetry());
+	update_generate_buttons();
 }
 
 void MainWindow::disable_buttons()
@@ -102,8 +130,14 @@ void MainWindow::open_file()
 
 	// Knot section
 	{
+		abandon_generating();
 		delete knot;
-		knot = new Knot(std::move(glyphs), GetStatusBar());
+		patches->warm(glyphs);
+		knot = new Knot(std::move(glyphs));
+		knot->method = menu_bar->generation_method();
+		knot->worker_count = menu_bar->worker_count();
+		knot->pattern = menu_bar->pattern();
+		update_patch_reuse();
 	}
 
 	// DisplayGrid and Tile section
@@ -148,13 +182,76 @@ void MainWindow::update_wrap_x()
 {
 	knot->wrapXEnabled = menu_bar->is_wrap_x();
 	if (buttons_enabled)
-		generate_region->enable_buttons(current_symmetry());
+		update_generate_buttons();
 }
 void MainWindow::update_wrap_y()
 {
 	knot->wrapYEnabled = menu_bar->is_wrap_y();
 	if (buttons_enabled)
-		generate_region->enable_buttons(current_symmetry());
+		update_generate_buttons();
+}
+void MainWindow::update_generation_method()
+{
+	knot->method = menu_bar->generation_method();
+}
+void MainWindow::update_worker_count()
+{
+	knot->worker_count = menu_bar->worker_count();
+}
+void MainWindow::update_patch_reuse()
+{
+	/// With a seed set, every knot is generated afresh from it, so that it can be reproduced.
+	knot->patches = menu_bar->reuse_patches() && !menu_bar->seed ? patches : nullptr;
+}
+void MainWindow::update_pattern()
+{
+	knot->pattern = menu_bar->pattern();
+}
+
+void MainWindow::set_seed()
+{
+	const wxString current = menu_bar->seed ? wxString::Format("%llu", static_cast<unsigned long long>(*menu_bar->seed)) : wxString();
+	wxTextEntryDialog dialog(this, "The seed to generate every knot from, as a whole number.\nLeave it empty to draw a fresh seed for each knot.", "Seed", current);
+	if (dialog.ShowModal() == wxID_CANCEL)
+		return;
+
+	const wxString text = dialog.GetValue().Trim().Trim(false);
+	unsigned long long value;
+	if (text.IsEmpty())
+		menu_bar->seed = std::nullopt;
+	else if (text.ToULongLong(&value))
+		menu_bar->seed = value;
+	else
+	{
+		wxMessageBox("The seed must be a whole number from 0 to 18446744073709551615.", "Error: Invalid seed");
+		return;
+	}
+	update_patch_reuse();
+}
+
+void MainWindow::load_style()
+{
+	wxFileDialog dialog(this, "Open Style file", "", "", File::style_ext, wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_CHANGE_DIR);
+	if (dialog.ShowModal() == wxID_CANCEL)
+		return;
+
+	std::optional<GlyphWeights> style = File::read_style(dialog.GetPath());
+	if (!style) // The function validates, and sends error messages with a messagebox, so no need for a message here
+		return;
+
+	menu_bar->style = std::make_shared<const GlyphWeights>(std::move(*style));
+	/// The patches kept so far were generated without this style, so start keeping them afresh.
+	patches = std::make_shared<PatchCache>();
+	update_patch_reuse();
+}
+void MainWindow::clear_style()
+{
+	if (!menu_bar->style)
+		return;
+
+	menu_bar->style = nullptr;
+	patches = std::make_shared<PatchCache>();
+	update_patch_reuse();
 }
 
 auto MainWindow::get_regen_dialog_handler(RegenDialog* regen_dialog)
@@ -167,8 +264,13 @@ auto MainWindow::get_regen_dialog_handler(RegenDialog* regen_dialog)
 
 		size = *opt_size;
 
+		abandon_generating();
 		delete knot;
-		knot = new Knot(size, GetStatusBar());
+		knot = new Knot(size);
+		knot->method = menu_bar->generation_method();
+		knot->worker_count = menu_bar->worker_count();
+		knot->pattern = menu_bar->pattern();
+		update_patch_reuse();
 
 		disp->resize(size);         // Resize the DisplayGrid,
 		menu_bar->reset_wrapping(); // Reset the wrapping checkboxes,
@@ -188,6 +290,26 @@ void MainWindow::regenerate_grid()
 	regen_dialog->Destroy();
 }
 
+void MainWindow::set_repeat_size()
+{
+	RegenDialog* repeat_dialog = new RegenDialog(menu_bar->repeat_size, "Repeat", "Set repeat size");
+	repeat_dialog->Bind(wxEVT_BUTTON, [this, repeat_dialog](wxCommandEvent& evt)
+		{
+			std::optional<GridSize> opt_size = repeat_dialog->get_size();
+			if (not opt_size)
+				return;
+
+			menu_bar->repeat_size = *opt_size;
+			update_pattern();
+
+			repeat_dialog->EndModal(0);
+			evt.Skip();
+		});
+
+	repeat_dialog->ShowModal();
+	repeat_dialog->Destroy();
+}
+
 void MainWindow::update_min_size()
 {
 	// To change the minimum size of the window to fit the content,
@@ -236,17 +358,54 @@ void MainWindow::generate_knot(wxCommandEvent& evt)
 	evt.Skip();
 }
 
-void MainWindow::generate_knot(Symmetry sym)
+namespace
 {
-	/// The Knot::generate() function uses the status bar, so first store the current displayed message.
-	const wxString oldStatus = GetStatusBar()->GetStatusText();
+	/// A message for the user listing the requirements in an unsatisfiable \c FeasibilityReport, with rows and columns numbered as in the axis labels
+	wxString describe_conflict(const FeasibilityReport& report)
+	{
+		if (report.conflict.empty())
+			return "The specified knot cannot be generated with this symmetry in this selection, whatever the locked tiles and surrounding glyphs are.";
 
+		const auto side_name = [](Movement side)
+			{
+				switch (side)
+				{
+				case Movement::up:    return "upper";
+				case Movement::down:  return "lower";
+				case Movement::left:  return "left";
+				case Movement::right: return "right";
+				}
+				throw;
+			};
+
+		wxString message = report.minimal
+			? "The specified knot cannot be generated, because these requirements conflict:\n"
+			: "The specified knot cannot be generated, because these requirements conflict, though some of them might not be needed:\n";
+		for (const ProblemRequirement& requirement : report.conflict)
+		{
+			const int row = requirement.point.i + 1;
+			const int column = requirement.point.j + 1;
+			switch (requirement.source)
+			{
+			case RequirementSource::locked:
+				message << wxString::Format("\n- The locked tile at row %i, column %i", row, column);
+				break;
+			case RequirementSource::grid_edge:
+				message << wxString::Format("\n- The %s side of row %i, column %i, which is on the edge of the grid", side_name(requirement.side), row, column);
+				break;
+			case RequirementSource::neighbour:
+				message << wxString::Format("\n- The %s side of row %i, column %i, which meets a tile outside the selection", side_name(requirement.side), row, column);
+				break;
+			}
+		}
+		return message;
+	}
+}
+
+void MainWindow::generate_knot(Symmetry sym)
+{
 	/// Each of the generating buttons has its symmetry type as its ID value. Get this symmetry from the event call.
-	/// Then, forward on this symmetry to Knot::generate() with the selection coordinates to be generated.
-	/// If this function returns \c true, then the Knot has been generated successfully,
-	/// so update the DisplayGrid with DisplayGrid::draw() and update the export text box with MainWindow::showExportBox().
-	/// If the generate function returns \c false, then display an error message as a \c wxMessageBox.
-	
+	/// Clearing the selection is immediate, so do it straight away, and update the DisplayGrid with DisplayGrid::render().
 	if (sym == Symmetry::Nothing)
 	{
 		knot->clear(disp->get_selection(), disp->get_tiles());
@@ -254,16 +413,236 @@ void MainWindow::generate_knot(Symmetry sym)
 		return;
 	}
 
-	if (knot->generate(sym, disp->get_selection(), disp->get_tiles())) {
+	/// Only one knot is generated at a time, and the buttons are disabled meanwhile, but a keyboard shortcut may still arrive.
+	if (generating())
+		return;
+
+	/// Then, forward on this symmetry to Knot::generator() with the selection to be generated, and run what it returns on a background thread,
+	/// so that the window keeps responding and generating can be stopped with MainWindow::stop_generating().
+	/// The thread never touches the window directly, and instead posts its progress and result as events, handled by
+	/// MainWindow::on_generation_progress() and MainWindow::on_generation_finished().
+	/// Each event carries the number of this generation, so that the events of one which has since been abandoned can be told apart.
+	knot->seed = menu_bar->seed;
+	knot->weights = menu_bar->style;
+	const Knot::FeasibilityCheck check = knot->feasibility(sym, disp->get_selection(), disp->get_tiles());
+	const Knot::Generator generate = knot->generator(sym, disp->get_selection(), disp->get_tiles());
+	const int id = ++generation_id;
+
+	/// The generate function uses the status bar, so first store the current displayed message, and disable the generate buttons until it finishes.
+	old_status = GetStatusBar()->GetStatusText();
+	generating_thread = std::jthread([this, check, generate, id](std::stop_token stop)
+		{
+			/// Before generating, the thread checks whether the knot is possible at all, so that a hopeless selection is reported straight away along with the reasons why,
+			/// as the message of a \c GENERATION_FINISHED event with no knot.
+			const FeasibilityReport report = check(stop);
+			if (report.feasibility == Feasibility::unsatisfiable)
+			{
+				wxThreadEvent* event = new wxThreadEvent(GENERATION_FINISHED);
+				event->SetInt(id);
+				event->SetString(describe_conflict(report));
+				event->SetPayload(Knot::Generated{});
+				wxQueueEvent(this, event);
+				return;
+			}
+
+
+			const auto progress = [this, id](const wxString& status)
+				{
+					wxThreadEvent* event = new wxThreadEvent(GENERATION_PROGRESS);
+					event->SetInt(id);
+					event->SetString(status);
+					wxQueueEvent(this, event);
+				};
+
+			wxThreadEvent* event = new wxThreadEvent(GENERATION_FINISHED);
+			event->SetInt(id);
+			event->SetPayload(generate(stop, progress));
+			wxQueueEvent(this, event);
+		});
+
+	update_generate_buttons();
+	menu_bar->set_generating(true);
+}
+
+void MainWindow::stop_generating()
+{
+	generating_thread.request_stop();
+}
+
+namespace
+{
+	/// A number given as its base ten logarithm, written out in full if it fits in the digits of a \c double, or in scientific notation if not
+	wxString describe_number(double log10_number)
+	{
+		if (std::isinf(log10_number))
+			return "0";
+		if (log10_number < 15)
+			return wxString::Format("%.0f", std::pow(10.0, log10_number));
+
+		const double exponent = std::floor(log10_number);
+		return wxString::Format("about %.3fe%.0f", std::pow(10.0, log10_number - exponent), exponent);
+	}
+}
+
+void MainWindow::count_knots()
+{
+	/// Counting uses the generating thread, so it cannot start while a knot is generating, and generating cannot start while it counts.
+	if (generating())
+		return;
+
+	/// Count the knots of each symmetry whose generate button would be enabled.
+	const Symmetry available = current_symmetry();
+	if (available == Symmetry::Nothing)
+	{
+		wxMessageBox("No knot can be generated in this selection with the current wrapping.", "Knot count");
+		return;
+	}
+
+	const std::pair<Symmetry, const char*> symmetries[] =
+	{
+		{ Symmetry::AnySym,      "No Symmetry" },
+		{ Symmetry::HoriSym,     "Horizontal Reflection" },
+		{ Symmetry::VertSym,     "Vertical Reflection" },
+		{ Symmetry::HoriVertSym, "Horizontal + Vertical" },
+		{ Symmetry::Rot2Sym,     "2-way Rotational" },
+		{ Symmetry::Rot4Sym,     "4-way Rotational" },
+		{ Symmetry::FwdDiag,     "Forward Diagonal" },
+		{ Symmetry::BackDiag,    "Backward Diagonal" },
+		{ Symmetry::FullSym,     "Full Symmetry" },
+	};
+
+	std::vector<std::pair<const char*, Knot::Counter>> counters;
+	for (const auto& [sym, name] : symmetries)
+	{
+		if (available % sym)
+			counters.emplace_back(name, knot->count_knots(sym, disp->get_selection(), disp->get_tiles()));
+	}
+
+	/// Each count takes up to \c COUNT_TIME_BUDGET, so as with MainWindow::generate_knot(), they run one after another on a background thread,
+	///	which posts its progress as events, and can be stopped with MainWindow::stop_generating(). The message is shown by MainWindow::on_counting_finished().
+	const int id = ++generation_id;
+	old_status = GetStatusBar()->GetStatusText();
+	generating_thread = std::jthread([this, counters, id](std::stop_token stop)
+		{
+			wxString message = "The number of knots which fit the selection:\n";
+			for (const auto& [name, counter] : counters)
+			{
+				wxThreadEvent* progress = new wxThreadEvent(GENERATION_PROGRESS);
+				progress->SetInt(id);
+				progress->SetString(wxString::Format("Counting knots: %s", name));
+				wxQueueEvent(this, progress);
+
+				/// A complete count is given exactly, along with how long it took, and an incomplete one as a lower bound, along with the rate at which knots were being listed.
+				const SolutionCount count = counter(stop);
+				if (stop.stop_requested())
+					break;
+				const double seconds = count.elapsed.count();
+				if (count.complete)
+					message << wxString::Format("\n%s: %s, counted in %.2f s", name, describe_number(count.log10_solutions), seconds);
+				else
+					message << wxString::Format("\n%s: at least %s, listing %s per second", name, describe_number(count.log10_solutions), describe_number(count.log10_solutions - std::log10(seconds)));
+			}
+
+			wxThreadEvent* event = new wxThreadEvent(COUNTING_FINISHED);
+			event->SetInt(id);
+			event->SetString(message);
+			wxQueueEvent(this, event);
+		});
+
+	update_generate_buttons();
+	menu_bar->set_generating(true);
+}
+
+void MainWindow::abandon_generating()
+{
+	if (!generating())
+		return;
+
+	generating_thread.request_stop();
+	generating_thread.join();
+	++generation_id;
+
+	GetStatusBar()->SetStatusText(old_status);
+	menu_bar->set_generating(false);
+}
+
+void MainWindow::update_generate_buttons()
+{
+	if (generating())
+		generate_region->disable_buttons();
+	else
+		generate_region->enable_buttons(current_symmetry());
+}
+
+void MainWindow::on_generation_progress(wxThreadEvent& event)
+{
+	if (event.GetInt() == generation_id)
+		GetStatusBar()->SetStatusText(event.GetString());
+}
+
+void MainWindow::on_generation_finished(wxThreadEvent& event)
+{
+	if (event.GetInt() != generation_id)
+		return;
+
+	const bool stopped = generating_thread.get_stop_token().stop_requested();
+	generating_thread.join();
+
+	/// If the Knot has been generated successfully, swap in the new glyphs all at once and update the DisplayGrid with DisplayGrid::render().
+	/// If it failed, rather than being stopped, display an error message as a \c wxMessageBox, giving the reasons if the thread found that the knot is impossible.
+	/// A failure is only put down to the time budget when it actually ran out, since most methods can also fail by showing that no knot fits, or by giving up.
+	Knot::Generated generated = event.GetPayload<Knot::Generated>();
+	const Knot::Statistics& statistics = generated.statistics;
+	if (generated.glyphs) {
+		knot->set_glyphs(std::move(*generated.glyphs));
 		disp->set_knot(knot);
 		disp->render();
 	}
+	else if (!stopped && !event.GetString().IsEmpty())
+		wxMessageBox(event.GetString(), "Error: Knot impossible");
+	else if (!stopped && statistics.timed_out)
+		wxMessageBox(wxString::Format("The specified knot was not able to be generated within %.0f seconds.", std::chrono::duration<double>(knot->time_budget).count()), "Error: Knot failed");
+	else if (!stopped)
+		wxMessageBox(wxString::Format("The specified knot was not able to be generated, since no knot fits the selection, or the generation method ran out of options after %.2f seconds.", std::chrono::duration<double>(statistics.elapsed).count()), "Error: Knot failed");
+
+	/// At the end, show where the new knot came from in the status bar, so that it can be generated again with MainWindow::set_seed(),
+	/// along with how long it took and what found it, or if there is none, set it back to the message which was displayed before generating. Then re-enable the generate buttons.
+	if (!generated.glyphs)
+		GetStatusBar()->SetStatusText(old_status);
+	else if (generated.seed)
+	{
+		wxString status = wxString::Format("Generated with seed %llu in %.2f s", static_cast<unsigned long long>(*generated.seed), std::chrono::duration<double>(statistics.elapsed).count());
+		if (statistics.attempts > 1)
+			status << wxString::Format(", %i attempts", statistics.attempts);
+		if (statistics.partial_restarts > 0)
+			status << wxString::Format(", %i partial restarts", statistics.partial_restarts);
+		if (!statistics.strategy.IsEmpty())
+			status << ", found by " << statistics.strategy;
+		GetStatusBar()->SetStatusText(status);
+	}
 	else
-		wxMessageBox(wxString::Format("The specified knot was not able to be generated in %i attempts.", MAX_ATTEMPTS), "Error: Knot failed");
+		GetStatusBar()->SetStatusText("Reused a stored patch");
+	menu_bar->set_generating(false);
+	if (buttons_enabled)
+		update_generate_buttons();
+}
+
+void MainWindow::on_counting_finished(wxThreadEvent& event)
+{
+	if (event.GetInt() != generation_id)
+		return;
+
+	const bool stopped = generating_thread.get_stop_token().stop_requested();
+	generating_thread.join();
+
+	GetStatusBar()->SetStatusText(old_status);
+	menu_bar->set_generating(false);
+	if (buttons_enabled)
+		update_generate_buttons();
 
-	/// At the end, set the status bar back to the message which was displayed at the beginning of the function,
-	/// and re-enable the generate buttons.
-	GetStatusBar()->SetStatusText(oldStatus);
+	/// If counting was stopped, the counts are incomplete and were not asked for any more, so nothing is shown.
+	if (!stopped)
+		wxMessageBox(event.GetString(), "Knot count");
 }
 
 
@@ -305,7 +684,10 @@ void MainWindow::on_key_press(wxKeyEvent& event)
 	{
 
 	case WXK_ESCAPE:
-		disp->unhighlight();
+		if (generating())
+			stop_generating();
+		else
+			disp->unhighlight();
 		break;
 
 	case WXK_DELETE:
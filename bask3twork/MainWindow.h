@@ -1,6 +1,8 @@
 #pragma once
 #include <wx/frame.h>
 #include <wx/sizer.h>
+#include <memory>
+#include <thread>
 #include "Forward.h"
 #include "pure/GridSize.h"
 
@@ -14,6 +16,7 @@ public:
 	void lock_selection(wxCommandEvent& evt);
 	void unlock_selection(wxCommandEvent& evt);
 	void invert_locking(wxCommandEvent& evt);
+	void lock_changed(Point point); ///< Called after one tile has been locked or unlocked on its own, such as by control-clicking it
 
 	void enable_buttons();
 	void disable_buttons();
@@ -36,6 +39,16 @@ public:
 	void export_grid();     ///< Open the "Export" dialog pop-up, giving the user the option to copy to the clipboard
 	void update_wrap_x();   ///< Grab the x wrapping from the menu bar, and refresh the buttons
 	void update_wrap_y();   ///< Grab the y wrapping from the menu bar, and refresh the buttons
+	void update_generation_method(); ///< Grab the generation method from the menu bar
+	void update_worker_count();      ///< Grab whether to use all cores from the menu bar
+	void update_patch_reuse();       ///< Grab whether to reuse patches from the menu bar
+	void set_seed();                 ///< Open a dialog pop-up for the seed to generate every knot from, or none to draw a fresh one each time
+	void load_style();               ///< Open a style file, weighting how likely each glyph is to be generated from then on
+	void clear_style();              ///< Go back to generating every glyph with equal chance
+	void update_pattern();           ///< Grab how the knot repeats from the menu bar
+	void set_repeat_size();          ///< Open a dialog pop-up for the period of a repeating knot
+	void stop_generating();          ///< Stop generating the current knot, leaving the knot as it was
+	void count_knots();              ///< Count the knots which fit the selection with each symmetry it allows, and show the counts in a message box
 	void regenerate_grid(); ///< Open the "Regenerate" dialog pop-up, and regenerate the grid if successful
 
 	auto get_regen_dialog_handler(RegenDialog* regen_dialog); ///< The function bound to the \c RegenDialog button
@@ -47,6 +60,7 @@ private:
 
 	DisplayGrid* disp; ///< The DisplayGrid for this program, i.e. the \c wxWindow that displays the Knot.
 	Knot* knot;        ///< The Knot object belonging to this program.
+	std::shared_ptr<PatchCache> patches; ///< The patches kept for rerolling, shared by every Knot which this program makes
 	wxBoxSizer* grid_sizer;
 
 	wxBoxSizer* main_sizer;
@@ -57,6 +71,19 @@ public:
 	void generate_knot(wxCommandEvent& evt); ///< This function checks which of the generating buttons was pressed and calls the appropriate Knot function.
 	void generate_knot(Symmetry sym);        ///< This function checks which of the generating buttons was pressed and calls the appropriate Knot function.
 
+private:
+	std::jthread generating_thread; ///< The thread running a Knot::Generator or the counts of MainWindow::count_knots(), joinable from when it starts until it posts that it has finished
+	int generation_id = 0;          ///< Counts the knots started generating, so that the events of one which has been abandoned are ignored
+	wxString old_status;            ///< The status bar message from before generating, restored once it finishes
+
+	bool generating() const { return generating_thread.joinable(); }
+	void abandon_generating();      ///< Stops generating and waits for the thread to finish, ignoring its result, so that the knot can be replaced
+	void update_generate_buttons(); ///< Enables the generate buttons which suit the selection, or disables them all while generating
+
+	void on_generation_progress(wxThreadEvent& event); ///< Shows the status posted by the generating thread
+	void on_generation_finished(wxThreadEvent& event); ///< Swaps in the knot generated by the generating thread, or reports why it failed
+	void on_counting_finished(wxThreadEvent& event);   ///< Shows the knots counted by the generating thread
+
 private:
 	static wxBoxSizer* make_region_sizer(LockingRegion* locking_region, GenerateRegion* generate_region);
 	static wxBoxSizer* make_grid_sizer(DisplayGrid* display);
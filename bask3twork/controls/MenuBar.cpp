@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "controls/MenuBar.h"
 #include "MainWindow.h"
+#include "grid/Knot.h"
 
 MenuBar::MenuBar(MainWindow* parent)
 	: wxMenuBar()
@@ -17,6 +18,31 @@ MenuBar::MenuBar(MainWindow* parent)
 	wrap_x = generate_menu->AppendCheckItem(static_cast<int>(MenuID::WRAP_X), "Wrap &X\tCtrl-X", "Toggle wrapping around the grid in the left-right direction.");
 	wrap_y = generate_menu->AppendCheckItem(static_cast<int>(MenuID::WRAP_Y), "Wrap &Y\tCtrl-Y", "Toggle wrapping around the grid in the up-down direction.");
 	generate_menu->AppendSeparator();
+	method_restarts    = generate_menu->AppendRadioItem(static_cast<int>(MenuID::METHOD_RESTARTS), "Random &restarts", "Fill the selection in order, starting over whenever a tile has no options.");
+	method_propagation = generate_menu->AppendRadioItem(static_cast<int>(MenuID::METHOD_PROPAGATION), "Constraint &propagation", "Narrow the options of every tile after each choice, to catch dead ends early.");
+	method_fewest_options = generate_menu->AppendRadioItem(static_cast<int>(MenuID::METHOD_FEWEST_OPTIONS), "&Fewest options first", "Narrow the options as in constraint propagation, but always fill the tile with the fewest options left next.");
+	method_backtracking = generate_menu->AppendRadioItem(static_cast<int>(MenuID::METHOD_BACKTRACKING), "&Backtracking", "Search every option, undoing only the choices which led to a dead end.");
+	method_repair = generate_menu->AppendRadioItem(static_cast<int>(MenuID::METHOD_REPAIR), "&Local repair", "Fill every tile straight away, then change only the tiles which do not fit until they all do.");
+	method_divide = generate_menu->AppendRadioItem(static_cast<int>(MenuID::METHOD_DIVIDE), "&Divide into blocks", "Generate the selection in blocks, then the seams between them, for very large knots.");
+	method_uniform = generate_menu->AppendRadioItem(static_cast<int>(MenuID::METHOD_UNIFORM), "&Uniform sampling", "Count every knot which fits, and pick one of them with equal chance, for narrow strips of the grid.");
+	method_propagation->Check(true);
+	parallel = generate_menu->AppendCheckItem(static_cast<int>(MenuID::PARALLEL), "Use all &cores", "Work on every core at once, for the methods which make independent attempts or divide the selection into blocks.");
+	reuse_patches_item = generate_menu->AppendCheckItem(static_cast<int>(MenuID::REUSE_PATCHES), "Reuse &patches", "Reroll a selection instantly with a knot generated before for the same surroundings, or found in an opened file.");
+	reuse_patches_item->Check(true);
+	generate_menu->Append(static_cast<int>(MenuID::SEED), "S&eed...", "Choose the seed of every random choice, so that the same selection and settings generate the same knot again.");
+	generate_menu->Append(static_cast<int>(MenuID::LOAD_STYLE), "Load st&yle...", "Open a style file, which weights how likely each glyph is to be generated.");
+	generate_menu->Append(static_cast<int>(MenuID::CLEAR_STYLE), "Clear s&tyle", "Go back to generating every glyph with equal chance.");
+	generate_menu->AppendSeparator();
+	repeat_none = generate_menu->AppendRadioItem(static_cast<int>(MenuID::REPEAT_NONE), "&No repeat", "Generate the whole selection freely.");
+	repeat_translate = generate_menu->AppendRadioItem(static_cast<int>(MenuID::REPEAT_TRANSLATE), "Repeat &tile", "Generate one tile of the repeat size, and copy it across the selection like a wallpaper.");
+	repeat_glide_across = generate_menu->AppendRadioItem(static_cast<int>(MenuID::REPEAT_GLIDE_ACROSS), "Repeat with glide &across", "Copy one tile across the selection, flipping it upside down with each step from left to right.");
+	repeat_glide_down = generate_menu->AppendRadioItem(static_cast<int>(MenuID::REPEAT_GLIDE_DOWN), "Repeat with glide &down", "Copy one tile across the selection, flipping it left to right with each step from top to bottom.");
+	repeat_none->Check(true);
+	generate_menu->Append(static_cast<int>(MenuID::REPEAT_SIZE), "Repeat si&ze...", "Set the number of rows and columns after which a repeating knot repeats.");
+	generate_menu->AppendSeparator();
+	stop_generating = generate_menu->Append(static_cast<int>(MenuID::STOP_GENERATING), "&Stop generating", "Stop generating the current knot, leaving it as it was. Pressing Escape does the same.");
+	stop_generating->Enable(false);
+	generate_menu->Append(static_cast<int>(MenuID::COUNT_KNOTS), "&Count knots", "Count the knots which fit the selection with each symmetry, to see how hard its locked tiles are to generate around.");
 	generate_menu->Append(static_cast<int>(MenuID::REGEN_GRID), "&Regenerate\tCtrl-R", "Resize and reinitialize the grid.");
 
 	Append(file_menu, "&File");
@@ -30,3 +56,44 @@ void MenuBar::reset_wrapping()
 	wrap_x->Check(false);
 	wrap_y->Check(false);
 }
+
+GenerationMethod MenuBar::generation_method() const
+{
+	if (method_restarts->IsChecked())
+		return GenerationMethod::restarts;
+	if (method_fewest_options->IsChecked())
+		return GenerationMethod::fewest_options;
+	if (method_backtracking->IsChecked())
+		return GenerationMethod::backtracking;
+	if (method_repair->IsChecked())
+		return GenerationMethod::repair;
+	if (method_divide->IsChecked())
+		return GenerationMethod::divide;
+	if (method_uniform->IsChecked())
+		return GenerationMethod::uniform;
+	return GenerationMethod::propagation;
+}
+
+int MenuBar::worker_count() const
+{
+	if (!parallel->IsChecked())
+		return 1;
+	return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+Pattern MenuBar::pattern() const
+{
+	Pattern pattern{ .period = repeat_size };
+	if (repeat_translate->IsChecked())
+		pattern.repeat = Repeat::translate;
+	if (repeat_glide_across->IsChecked())
+		pattern.repeat = Repeat::glide_across;
+	if (repeat_glide_down->IsChecked())
+		pattern.repeat = Repeat::glide_down;
+	return pattern;
+}
+
+void MenuBar::set_generating(bool generating)
+{
+	stop_generating->Enable(generating);
+}
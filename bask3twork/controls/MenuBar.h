@@ -1,6 +1,9 @@
 #pragma once
 #include <wx/menu.h>
 #include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include "MainWindow.h"
 
 class MenuBar : wxMenuBar
@@ -12,6 +15,14 @@ public:
 
 	bool is_wrap_x() const { return wrap_x->IsChecked(); }
 	bool is_wrap_y() const { return wrap_y->IsChecked(); }
+	GenerationMethod generation_method() const;
+	int worker_count() const;
+	bool reuse_patches() const { return reuse_patches_item->IsChecked(); }
+	Pattern pattern() const;
+	GridSize repeat_size = { 4, 4 }; ///< The period of the pattern, set with MainWindow::set_repeat_size()
+	std::optional<std::uint64_t> seed; ///< The seed of every knot generated, set with MainWindow::set_seed(), or \c std::nullopt to draw a fresh one for each knot
+	std::shared_ptr<const GlyphWeights> style; ///< How likely each glyph is to be generated, set with MainWindow::load_style(), or \c nullptr for every glyph equally likely
+	void set_generating(bool generating);
 
 	enum class MenuID
 	{
@@ -20,6 +31,25 @@ public:
 		EXPORT_GRID,
 		WRAP_X,
 		WRAP_Y,
+		METHOD_RESTARTS,
+		METHOD_PROPAGATION,
+		METHOD_FEWEST_OPTIONS,
+		METHOD_BACKTRACKING,
+		METHOD_REPAIR,
+		METHOD_DIVIDE,
+		METHOD_UNIFORM,
+		PARALLEL,
+		REUSE_PATCHES,
+		SEED,
+		LOAD_STYLE,
+		CLEAR_STYLE,
+		REPEAT_NONE,
+		REPEAT_TRANSLATE,
+		REPEAT_GLIDE_ACROSS,
+		REPEAT_GLIDE_DOWN,
+		REPEAT_SIZE,
+		STOP_GENERATING,
+		COUNT_KNOTS,
 		REGEN_GRID,
 	};
 
@@ -30,6 +60,25 @@ public:
 		&MainWindow::export_grid,
 		&MainWindow::update_wrap_x,
 		&MainWindow::update_wrap_y,
+		&MainWindow::update_generation_method,
+		&MainWindow::update_generation_method,
+		&MainWindow::update_generation_method,
+		&MainWindow::update_generation_method,
+		&MainWindow::update_generation_method,
+		&MainWindow::update_generation_method,
+		&MainWindow::update_generation_method,
+		&MainWindow::update_worker_count,
+		&MainWindow::update_patch_reuse,
+		&MainWindow::set_seed,
+		&MainWindow::load_style,
+		&MainWindow::clear_style,
+		&MainWindow::update_pattern,
+		&MainWindow::update_pattern,
+		&MainWindow::update_pattern,
+		&MainWindow::update_pattern,
+		&MainWindow::set_repeat_size,
+		&MainWindow::stop_generating,
+		&MainWindow::count_knots,
 		&MainWindow::regenerate_grid,
 	};
 
@@ -39,4 +88,18 @@ private:
 	wxMenu* generate_menu;
 	wxMenuItem* wrap_x;
 	wxMenuItem* wrap_y;
+	wxMenuItem* method_restarts;
+	wxMenuItem* method_propagation;
+	wxMenuItem* method_fewest_options;
+	wxMenuItem* method_backtracking;
+	wxMenuItem* method_repair;
+	wxMenuItem* method_divide;
+	wxMenuItem* method_uniform;
+	wxMenuItem* parallel;
+	wxMenuItem* reuse_patches_item;
+	wxMenuItem* repeat_none;
+	wxMenuItem* repeat_translate;
+	wxMenuItem* repeat_glide_across;
+	wxMenuItem* repeat_glide_down;
+	wxMenuItem* stop_generating;
 };
@@ -5,13 +5,13 @@
 #include "pure/GridSize.h"
 #include "pure/Selection.h"
 
-RegenDialog::RegenDialog(GridSize size)
-	: wxDialog(nullptr, wxID_ANY, "Grid")
+RegenDialog::RegenDialog(GridSize size, const wxString& title, const wxString& label)
+	: wxDialog(nullptr, wxID_ANY, title)
 	, textbox_sizer(new wxBoxSizer(wxHORIZONTAL))
 	, height_box(new RegenDialogTextBox(this, size.rows))
 	, width_box(new RegenDialogTextBox(this, size.columns))
 	, main_sizer(new wxBoxSizer(wxVERTICAL))
-	, button(new wxButton(this, wxID_ANY, "Regenerate"))
+	, button(new wxButton(this, wxID_ANY, label))
 {
 	SetIcon(wxIcon(L"AppIcon"));
 	Bind(wxEVT_CHAR_HOOK, &RegenDialog::on_exit, this);
@@ -59,13 +59,13 @@ std::optional<int> RegenDialogTextBox::get_value() const
 	int number;
 	if (string.ToInt(&number) == false)
 	{
-		wxMessageBox("You can only enter whole numbers for the new grid size.", "Error: Non-integer grid size");
+		wxMessageBox("You can only enter whole numbers for the new size.", "Error: Non-integer size");
 		return std::nullopt;
 	}
 
 	else if (number < 1)
 	{
-		wxMessageBox("You can only enter positive numbers for the new grid size.", "Error: Non-positive grid size");
+		wxMessageBox("You can only enter positive numbers for the new size.", "Error: Non-positive size");
 		return std::nullopt;
 	}
 
@@ -6,7 +6,7 @@
 class RegenDialog : public wxDialog
 {
 public:
-	RegenDialog(GridSize size);
+	RegenDialog(GridSize size, const wxString& title = "Grid", const wxString& label = "Regenerate");
 
 	std::optional<GridSize> get_size() const;
 
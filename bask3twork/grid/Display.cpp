@@ -89,6 +89,7 @@ void DisplayGrid::on_left_down(wxMouseEvent& evt)
 		tile.locked()
 			? tile.unlock()
 			: tile.lock();
+		parent->lock_changed(tile_pos);
 		render();
 		return evt.Skip();
 	}
@@ -285,30 +286,34 @@ void DisplayGrid::unlock(Point point)
 
 void DisplayGrid::lock()
 {
-	for (Point p : SelectionRange(selection))
-		tiles[p.i][p.j].lock();
+	change_selected([](Tile& tile) { tile.lock(); });
 	render();
 }
 
 void DisplayGrid::unlock()
 {
-	for (Point p : SelectionRange(selection))
-		tiles[p.i][p.j].unlock();
+	change_selected([](Tile& tile) { tile.unlock(); });
 	render();
 }
 
 void DisplayGrid::invert_locking()
 {
-	for (Point p : SelectionRange(selection))
-	{
-		Tile& tile = tiles[p.i][p.j];
-		tile.locked()
-			? tile.unlock()
-			: tile.lock();
-	}
+	change_selected([](Tile& tile)
+		{
+			tile.locked()
+				? tile.unlock()
+				: tile.lock();
+		});
 	render();
 }
 
+void DisplayGrid::change_selected(void (*change)(Tile&))
+/// Calls \c change on every selected tile, split between threads, since each call only touches its own tile.
+{
+	const std::span<const Point> cells = SelectionRange(selection).cells(selected_cells);
+	std::for_each(std::execution::par_unseq, cells.begin(), cells.end(), [&](Point p) { change(tiles[p.i][p.j]); });
+}
+
 
 
 void DisplayGrid::make_tiles()
@@ -67,7 +67,9 @@ private:
 	std::optional<wxBitmap> background_cache = {};
 
 	Tiles tiles;
+	std::vector<Point> selected_cells; ///< The cells of \c selection, kept between calls to DisplayGrid::change_selected() so that its storage is reused
 	void make_tiles();
+	void change_selected(void (*change)(Tile&));
 	void update_tile_offsets();
 
 	wxPoint x_label_offset(int pos) const;
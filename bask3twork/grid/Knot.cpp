@@ -1,30 +1,64 @@
 #include "pch.h"
+#include "Allocations.h"
 #include "pure/GridSize.h"
 #include "grid/Knot.h"
 #include "pure/Glyph.h"
+#include "pure/GlyphWeights.h"
+#include "pure/OrbitTable.h"
+#include "pure/Random.h"
 #include "pure/Selection.h"
+#include "pure/SelectionIterator.h"
 #include "pure/SelectionZip.h"
 #include "pure/Symmetry.h"
+#include "solver/Backtracking.h"
+#include "solver/Enumeration.h"
+#include "solver/Feasibility.h"
+#include "solver/Problem.h"
+#include "solver/Propagation.h"
+#include "solver/Repair.h"
+#include "solver/StripSampler.h"
+#include "grid/PatchCache.h"
 #include "grid/Tile.h" // This breaks the dependency direction between folders, todo change this later (maybe)
 #include "Constants.h"
 
-Knot::Knot(GridSize size, wxStatusBar* statusBar) : size(size), statusBar(statusBar), glyphs(size.rows, std::vector<const Glyph*>(size.columns, SpaceGlyph)) {}
-Knot::Knot(Glyphs&& glyphs, wxStatusBar* statusBar) : size{ .rows = (int)glyphs.size(), .columns = (int)glyphs[0].size() }, statusBar(statusBar), glyphs(std::move(glyphs)) {}
-wxUniChar Knot::get(const int i, const int j) const { return wxUniChar(glyphs[i][j]->code_point); }
-CodePoint Knot::code_point(const int i, const int j) const { return glyphs[i][j]->code_point; }
+Knot::Knot(GridSize size) : size(size), glyphs(size) {}
+Knot::Knot(Glyphs&& glyphs) : size(glyphs.size()), glyphs(std::move(glyphs)) {}
+wxUniChar Knot::get(const int i, const int j) const { return wxUniChar(glyphs[{ i, j }]->code_point); }
+CodePoint Knot::code_point(const int i, const int j) const { return glyphs[{ i, j }]->code_point; }
 
 void Knot::clear(Selection selection, const Tiles& tiles)
 {
+	const std::uint8_t space = GlyphGrid::encode(SpaceGlyph);
 	for (int i = selection.min.i; i <= selection.max.i; i++)
-	for (int j = selection.min.j; j <= selection.max.j; j++)
 	{
-		if (!tiles[i][j].locked())
-			glyphs[i][j] = SpaceGlyph;
+		const std::span<std::uint8_t> row = selection.within(glyphs.row(i));
+		const std::span<const Tile> tile_row = selection.within(tiles[i]);
+		for (std::size_t j = 0; j < row.size(); j++)
+		{
+			if (!tile_row[j].locked())
+				row[j] = space;
+		}
 	}
+	symmetry_tracker.glyphs_changed(glyphs);
 }
 
 bool Knot::generate(Symmetry sym, Selection selection, const Tiles& tiles)
-/** Generate a knot with the given symmetry in the given selection.
+/** Generate a knot with the given symmetry in the given selection, on the calling thread, see Knot::generator().
+ *
+ * \return A boolean value denoting whether or not the generating was successful
+ */
+{
+	Generated generated = generator(sym, selection, tiles)({}, {});
+	if (!generated.glyphs)
+		return false;
+
+	glyphs = std::move(*generated.glyphs);
+	symmetry_tracker.glyphs_changed(glyphs);
+	return true;
+}
+
+Knot::Generator Knot::generator(Symmetry sym, Selection selection, const Tiles& tiles) const
+/** Prepare to generate a knot with the given symmetry in the given selection.
  *
  * Only generates from row \c iMin to row \c iMax, and from column \c jMin to column \c jMax.
  * This function assumes \c iMin \c <= \c iMax and \c jMin \c <= \c jMax, and does not check the values.
@@ -32,63 +66,684 @@ bool Knot::generate(Symmetry sym, Selection selection, const Tiles& tiles)
  * This function does not check the boundary symmetries to determine whether the specified symmetry is allowed.
  * The knot will generate with undefined behaviour if the proper symmetry conditions are not met in the first place.
  *
+ * The glyphs, locked tiles and settings are all copied when this is called, so the returned \c Generator can run on another thread
+ * while this Knot and its tiles carry on being used and changed. Its result is then put in place with Knot::set_glyphs().
+ *
+ * Every random choice is drawn from \c seed, so the same seed and settings always generate the same knot, on any number of threads,
+ * as long as no patch is taken from \c patches, and the knot is found within \c time_budget. If \c seed is not set, a fresh one is drawn here.
+ * Either way, the seed is returned along with the knot, and with the \c Statistics of how it was found.
+ *
  * \param sym The symmetry of the knot to be generated
- * \param iMin The zero-indexed upper row of the selection visually(lower numerically)
- * \param jMin The zero-indexed leftmost column of the selection
- * \param iMax The zero-indexed lower row of the selection visually(higher numerically)
- * \param jMax The zero-indexed rightmost column of the selection
- * \return A boolean value denoting whether or not the generating was successful
- * 
+ * \param selection The selection to generate, with the locked tiles in \c tiles kept as they are
+ * \return A function which generates the whole grid of glyphs, returning no glyphs if the generating failed or was stopped, along with whether it ran out of time
+ *
+ * \b Method
+ */
+{
+	/// The work is done by Knot::generate_by_method(), unless the selection is rerolled with a patch from \c patches, see \c PatchCache.
+	/// Uniform sampling never takes a patch, since the patches kept are not drawn uniformly.
+	Knot seeded = *this;
+	if (!seeded.seed)
+		seeded.seed = fresh_seed();
+
+	return [knot = std::move(seeded), base_glyphs = make_base_glyphs(sym, selection, tiles), sym, selection](std::stop_token stop, const Progress& progress) -> Generated
+		{
+			const bool reusing = knot.patches && knot.method != GenerationMethod::uniform;
+			PatchCache::Key key;
+			if (reusing)
+			{
+				key = PatchCache::key_of(base_glyphs, selection, sym, knot.pattern, knot.wrapXEnabled, knot.wrapYEnabled);
+				if (std::optional<Glyphs> patched = knot.patches->take(key, base_glyphs, selection, knot.glyphs))
+					return Generated{ std::move(*patched), std::nullopt, {} };
+			}
+
+			/// The time budget is enforced by stopping, which every method already checks for, so that none of them has to watch the clock itself.
+			///	A timer thread requests the stop once the budget runs out, unless generating has finished first, and a stop requested from outside is passed straight on.
+			const auto start = std::chrono::steady_clock::now();
+			std::stop_source budget;
+			const std::stop_callback forward(stop, [&budget] { budget.request_stop(); });
+			const std::jthread timer([&budget, deadline = start + knot.time_budget](std::stop_token finished)
+				{
+					std::mutex mutex;
+					std::condition_variable_any wake;
+					std::unique_lock lock(mutex);
+					wake.wait_until(lock, finished, deadline, [] { return false; });
+					if (!finished.stop_requested())
+						budget.request_stop();
+				});
+
+			Statistics statistics;
+			std::optional<Glyphs> generated = knot.generate_by_method(sym, selection, base_glyphs, budget.get_token(), progress, statistics);
+			statistics.elapsed = std::chrono::steady_clock::now() - start;
+			if (!generated)
+			{
+				/// Only the timer stops the budget without \c stop, so a failure is put down to the time budget only then, and otherwise to the method itself.
+				statistics.timed_out = budget.stop_requested() && !stop.stop_requested();
+				return Generated{ std::nullopt, knot.seed, std::move(statistics) };
+			}
+			if (reusing)
+				knot.patches->store(key, *generated, selection);
+			return Generated{ std::move(generated), knot.seed, std::move(statistics) };
+		};
+}
+
+std::optional<Glyphs> Knot::generate_by_method(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const
+/** Called only from Knot::generator(), generate the selection with one of the \c generate_ methods, such as Knot::generate_propagating(), depending on \c method.
+ *
+ * Random restarts and dividing do not pose the whole selection as one \c Problem, so they cannot follow a repeating \c pattern, which is generated by constraint propagation instead.
+ */
+{
+	const bool follows_pattern = method != GenerationMethod::restarts && method != GenerationMethod::divide;
+	switch (pattern.repeat == Repeat::none || follows_pattern ? method : GenerationMethod::propagation)
+	{
+	case GenerationMethod::restarts:       return generate_restarting(sym, selection, base_glyphs, stop, progress, statistics);
+	case GenerationMethod::propagation:
+	case GenerationMethod::fewest_options: return generate_propagating(sym, selection, base_glyphs, stop, progress, statistics);
+	case GenerationMethod::backtracking:   return generate_backtracking(sym, selection, base_glyphs, stop, progress, statistics);
+	case GenerationMethod::repair:         return generate_repairing(sym, selection, base_glyphs, stop, progress, statistics);
+	case GenerationMethod::divide:         return generate_dividing(sym, selection, base_glyphs, stop, progress, statistics);
+	case GenerationMethod::uniform:        return generate_sampling(sym, selection, base_glyphs, stop, progress, statistics);
+	}
+	throw;
+}
+
+void Knot::set_glyphs(Glyphs&& newGlyphs)
+{
+	glyphs = std::move(newGlyphs);
+	symmetry_tracker.glyphs_changed(glyphs);
+}
+
+std::optional<Glyphs> Knot::make_attempts(Symmetry sym, const Glyphs& base_glyphs, const Attempt& attempt, std::stop_token stop, const Progress& progress, Statistics& statistics) const
+/** Called from the methods of Knot::generator() which make independent attempts, call \c attempt until it succeeds, or \c stop is requested, such as when \c time_budget runs out.
+ *
+ * Each attempt draws from its own stream of \c seed, numbered by the attempt, so that the knot only depends on the seed and never on the threads.
+ * With a \c worker_count of 1, the attempts are made one after another on this thread.
+ * Otherwise, each worker thread takes the next attempt from one shared count of attempts, while this thread reports the count through \c progress.
+ * A success stops every attempt after it, but the attempts before it are still finished, and the first success of all is kept,
+ * so that the result is the same knot as with one thread.
+ *
+ * Each thread makes its own copy of \c base_glyphs and of \c attempt, along with any scratch storage it holds, before its first attempt.
+ * Every attempt then reuses those, so that the attempts themselves make no heap allocations, which debug builds assert with allocation_count(),
+ * except that with \c weights, the first attempt on each thread allocates the slots of its alias tables, see \c GlyphWeights.
+ *
+ * \b Method
+ */
+{
+	const wxString& prefix = status_prefix(sym);
+
+	if (worker_count <= 1)
+	{
+		Glyphs glyphs = base_glyphs;
+		Attempt own_attempt = attempt;
+
+		/// Enter a loop, counting the number of attempts made at generating this knot. The steps are as follows.
+		for (int attempts = 1; ; attempts++) {
+			/// \b (1) At certain intervals of numbers of attempts, report the number of attempts made, and stop if asked to, or if the time budget has run out.
+			if (stop.stop_requested())
+				return std::nullopt;
+			if (progress && attempts % ATTEMPTS_DISPLAY_INCREMENT == 0)
+				progress(wxString::Format("%sAttempt %i", prefix, attempts));
+
+			/// \b (2) Call \c attempt on the same \c glyphs as every other attempt. If it fails, \c continue the loop and try again.
+			Rng rng(*seed, attempts);
+			int partial_restarts = 0;
+			const std::size_t allocations = allocation_count();
+			const bool succeeded = own_attempt(rng, glyphs, partial_restarts);
+			wxASSERT_MSG(attempts == 1 || allocation_count() == allocations, "An attempt at generating allocated on the heap");
+			statistics.attempts = attempts;
+			statistics.partial_restarts += partial_restarts;
+			if (!succeeded) continue;
+
+			/// \b (3) If the knot has been successfully generated, return it, noting whether it took a partial restart.
+			statistics.strategy = partial_restarts == 0 ? "a full restart" : "a partial restart";
+			return glyphs;
+		}
+	}
+
+	std::atomic<int> attempts = 0;
+	std::atomic<int> running = worker_count;
+	std::atomic<int> first_success = std::numeric_limits<int>::max();
+	std::atomic<int> total_partial_restarts = 0;
+	int winning_partial_restarts = 0;
+	std::mutex result_mutex;
+	std::optional<Glyphs> result;
+
+	{
+		std::vector<std::jthread> workers;
+		for (int worker = 0; worker < worker_count; ++worker)
+		{
+			workers.emplace_back([&]
+				{
+					Glyphs glyphs = base_glyphs;
+					Attempt own_attempt = attempt;
+
+					for (int number = ++attempts, made = 0; number < first_success && !stop.stop_requested(); number = ++attempts, ++made)
+					{
+						Rng rng(*seed, number);
+						int partial_restarts = 0;
+						const std::size_t allocations = allocation_count();
+						const bool succeeded = own_attempt(rng, glyphs, partial_restarts);
+						wxASSERT_MSG(made == 0 || allocation_count() == allocations, "An attempt at generating allocated on the heap");
+						total_partial_restarts += partial_restarts;
+						if (!succeeded) continue;
+
+						/// The attempts are handed out in order, so once this one has succeeded, this worker has no earlier attempt left to make.
+						std::scoped_lock lock(result_mutex);
+						if (number < first_success)
+						{
+							result = std::move(glyphs);
+							first_success = number;
+							winning_partial_restarts = partial_restarts;
+						}
+						break;
+					}
+					--running;
+				});
+		}
+
+		while (running > 0)
+		{
+			std::this_thread::sleep_for(PARALLEL_DISPLAY_INTERVAL);
+			if (progress)
+				progress(wxString::Format("%sAttempt %i", prefix, static_cast<int>(attempts)));
+		}
+	}
+
+	/// A result found just as \c stop was requested is still thrown away, so that stopping never changes the knot.
+	if (stop.stop_requested())
+		return std::nullopt;
+	if (result)
+	{
+		statistics.attempts = first_success;
+		statistics.strategy = winning_partial_restarts == 0 ? "a full restart" : "a partial restart";
+	}
+	else
+		statistics.attempts = attempts;
+	statistics.partial_restarts = total_partial_restarts;
+	return result;
+}
+
+std::optional<Glyphs> Knot::generate_restarting(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const
+/** Called only from Knot::generator(), generate the selection by calling Knot::tryGenerating() until it succeeds, see Knot::make_attempts().
+ */
+{
+	/// The instantiation of Knot::tryGenerating() for the symmetry, and the orbits it visits, are chosen once here, so that the attempts never test the symmetry again.
+	const OrbitTable orbits(sym, selection);
+	bool (Knot::* try_generating)(Glyphs&, const Glyphs&, const OrbitTable&, Rng&) const = nullptr;
+	switch (sym) {
+	case Symmetry::AnySym:      try_generating = &Knot::tryGenerating<Symmetry::AnySym>;      break;
+	case Symmetry::HoriSym:     try_generating = &Knot::tryGenerating<Symmetry::HoriSym>;     break;
+	case Symmetry::VertSym:     try_generating = &Knot::tryGenerating<Symmetry::VertSym>;     break;
+	case Symmetry::HoriVertSym: try_generating = &Knot::tryGenerating<Symmetry::HoriVertSym>; break;
+	case Symmetry::Rot2Sym:     try_generating = &Knot::tryGenerating<Symmetry::Rot2Sym>;     break;
+	case Symmetry::Rot4Sym:     try_generating = &Knot::tryGenerating<Symmetry::Rot4Sym>;     break;
+	case Symmetry::FwdDiag:     try_generating = &Knot::tryGenerating<Symmetry::FwdDiag>;     break;
+	case Symmetry::BackDiag:    try_generating = &Knot::tryGenerating<Symmetry::BackDiag>;    break;
+	case Symmetry::FullSym:     try_generating = &Knot::tryGenerating<Symmetry::FullSym>;     break;
+	default:
+		throw;
+	}
+
+	return make_attempts(sym, base_glyphs, [&](Rng& rng, Glyphs& glyphs, int&) { return (this->*try_generating)(glyphs, base_glyphs, orbits, rng); }, stop, progress, statistics);
+}
+
+std::optional<Glyphs> Knot::generate_propagating(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const
+/** Called only from Knot::generator(), generate the selection by constraint propagation.
+ *
+ * Each attempt assigns the symmetry orbits of the selection one at a time, and after every assignment removes the glyphs which can no longer fit
+ * from the domains of the neighbouring cells, the cells across a wrapped edge, and the symmetric images of all of those.
+ * An attempt fails as soon as any domain becomes empty, rather than when the raster order happens to reach the cell.
+ * With \c GenerationMethod::fewest_options, the orbits are assigned fewest options first rather than in raster order, see Propagator::fill_fewest_first().
+ *
+ * \b Method
+ */
+{
+	/// First, pose the selection as a \c Problem, and propagate the fixed glyphs and edges once.
+	///	If this already empties a domain, then no attempt can succeed, so return \c std::nullopt straight away.
+	const Problem problem(base_glyphs, selection, sym, wrapXEnabled, wrapYEnabled, pattern, weights.get());
+
+	Propagator initial(problem);
+	if (!initial.propagate())
+		return std::nullopt;
+
+	/// Next, make attempts as in Knot::generate_restarting().
+	///	Each attempt starts over from the propagated initial state, and makes random choices until every orbit is assigned or a domain empties.
+	///	When a domain empties, the attempt first starts over only around where it did, clearing a wider area each time, see Propagator::restart_near_failure(),
+	///	and only once \c PARTIAL_RESTARTS of those have failed does it give up, leaving the next attempt to start over from scratch.
+	///	Every thread has its own copy of \c propagator, which is assigned the initial state each time rather than being copied afresh, so that its storage is reused.
+	const auto fill = method == GenerationMethod::fewest_options ? &Propagator::fill_fewest_first : &Propagator::fill_randomly;
+	const auto attempt = [&, propagator = initial](Rng& rng, Glyphs& glyphs, int& partial_restarts) mutable
+		{
+			propagator = initial;
+			bool filled = (propagator.*fill)(rng);
+			for (int restart = 1; !filled && restart <= PARTIAL_RESTARTS && propagator.restart_near_failure(initial, restart * PARTIAL_RESTART_RADIUS); ++restart)
+			{
+				++partial_restarts;
+				filled = (propagator.*fill)(rng);
+			}
+			if (!filled)
+				return false;
+			propagator.place(glyphs);
+			return true;
+		};
+
+	return make_attempts(sym, base_glyphs, attempt, stop, progress, statistics);
+}
+
+std::optional<Glyphs> Knot::generate_backtracking(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const
+/** Called only from Knot::generator(), generate the selection by a depth-first search with conflict-directed backjumping.
+ *
+ * The cells are assigned in the same order as Knot::tryGenerating(), with each symmetric image placed along with the first cell of its orbit.
+ * A dead end only undoes the assignments back to the latest one which caused it, so the search never repeats work from scratch,
+ * and given enough backtracks it finds a knot whenever one exists.
+ *
+ * \b Method
+ */
+{
+	/// First, pose the selection as a \c Problem, and propagate the fixed glyphs and edges once, as in Knot::generate_propagating().
+	const Problem problem(base_glyphs, selection, sym, wrapXEnabled, wrapYEnabled, pattern, weights.get());
+
+	Propagator initial(problem);
+	if (!initial.propagate())
+		return std::nullopt;
+
+	const wxString& prefix = status_prefix(sym);
+	Rng rng(*seed);
+
+	/// Next, search from the propagated domains, starting over whenever a run takes too long, until \c time_budget runs out, and reporting the number of backtracks as it goes.
+	Backtracker::Progress report;
+	if (progress)
+		report = [&](int backtracks) { progress(wxString::Format("%sBacktrack %i", prefix, backtracks)); };
+	RestartStatistics restarts;
+	const std::optional<std::vector<std::size_t>> values = solve_with_restarts(problem, initial.domains(), rng, std::numeric_limits<int>::max(), report, stop, &restarts);
+
+	statistics.attempts = restarts.runs;
+	if (!values)
+		return std::nullopt;
+	statistics.strategy = restarts.winner == RestartSchedule::luby ? "a Luby run" : "a geometric run";
+	return problem.solution(base_glyphs, *values);
+}
+
+std::optional<Glyphs> Knot::generate_repairing(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const
+/** Called only from Knot::generator(), generate the selection by local repair.
+ *
+ * Rather than throwing away a whole attempt when one cell has no options, every cell is given a glyph straight away, even if it does not fit,
+ * and then only the orbits which do not fit are changed, along with their symmetric images, until none are left or \c time_budget runs out.
+ * On a large selection, fixing a few cells is much cheaper than filling thousands of cells again. Unlike Knot::generate_backtracking(), this cannot show that no knot exists.
+ *
+ * \b Method
+ */
+{
+	/// First, pose the selection as a \c Problem, and propagate the fixed glyphs and edges once, as in Knot::generate_propagating().
+	const Problem problem(base_glyphs, selection, sym, wrapXEnabled, wrapYEnabled, pattern, weights.get());
+
+	Propagator initial(problem);
+	if (!initial.propagate())
+		return std::nullopt;
+
+	const wxString& prefix = status_prefix(sym);
+	Rng rng(*seed);
+
+	/// Next, repair from the propagated domains, reporting the number of mismatched edges left as it goes.
+	Repairer repairer(problem, initial.domains());
+	Repairer::Progress report;
+	if (progress)
+		report = [&](int conflicts) { progress(wxString::Format("%sMismatches left %i", prefix, conflicts)); };
+	const std::optional<std::vector<std::size_t>> values = repairer.solve(rng, time_budget, report, stop);
+	statistics.attempts = repairer.repairs();
+	statistics.strategy = "local repair";
+
+	if (!values)
+		return std::nullopt;
+	return problem.solution(base_glyphs, *values);
+}
+
+std::optional<Glyphs> Knot::generate_dividing(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const
+/** Called only from Knot::generator(), generate a large selection in blocks on several threads, then stitch the seams between them.
+ *
+ * The selection is cut into blocks of about \c DIVIDE_BLOCK_SIZE tiles square, with seams \c DIVIDE_SEAM_WIDTH tiles wide between them.
+ * Each block only touches seams, which are still empty, and whatever is fixed around the selection, so the blocks can all be generated at once, each as in Knot::generate_backtracking().
+ * Then each length of seam between two blocks is generated to match the blocks on both of its sides, and lastly each crossing where the seams meet, one after another,
+ * so that any crossing which the strands around it leave unable to close can hand the problem on to the next.
+ * The cost of each of these grows with the size of the block rather than of the whole selection, so there is no limit to the size of knot this can generate.
+ *
+ * Only \c Symmetry::AnySym is divided, since the images of a symmetric knot tie distant blocks together.
+ * Other symmetries, and selections too small for more than one block, are generated by Knot::generate_backtracking() instead.
+ *
  * \b Method
  */
 {
-	Glyphs base_glyphs = make_base_glyphs(sym, selection, tiles);
+	/// First, cut each direction of the selection into blocks and seams.
+	///	Where the selection wraps around the grid in that direction, it also starts with a seam, which meets the last block across the wrap.
+	struct Span
+	{
+		int min;
+		int max;
+		bool seam;
+	};
+	const auto cut = [](int min, int max, bool wraps)
+		{
+			const int blocks = std::max(1, (max - min + 1 + DIVIDE_SEAM_WIDTH) / (DIVIDE_BLOCK_SIZE + DIVIDE_SEAM_WIDTH));
+			if (blocks == 1)
+				return std::vector<Span>{ { min, max, false } };
+
+			std::vector<Span> spans;
+			if (wraps)
+			{
+				spans.push_back({ min, min + DIVIDE_SEAM_WIDTH - 1, true });
+				min += DIVIDE_SEAM_WIDTH;
+			}
+			const int block_tiles = max - min + 1 - (blocks - 1) * DIVIDE_SEAM_WIDTH;
+			for (int block = 0; block < blocks; ++block)
+			{
+				if (block != 0)
+				{
+					spans.push_back({ min, min + DIVIDE_SEAM_WIDTH - 1, true });
+					min += DIVIDE_SEAM_WIDTH;
+				}
+				const int length = block_tiles / blocks + (block < block_tiles % blocks);
+				spans.push_back({ min, min + length - 1, false });
+				min += length;
+			}
+			return spans;
+		};
+
+	const bool wraps_rows = wrapYEnabled && selection.min.i == 0 && selection.max.i == size.rows - 1;
+	const bool wraps_columns = wrapXEnabled && selection.min.j == 0 && selection.max.j == size.columns - 1;
+	const std::vector<Span> row_spans = cut(selection.min.i, selection.max.i, wraps_rows);
+	const std::vector<Span> column_spans = cut(selection.min.j, selection.max.j, wraps_columns);
+	if (sym != Symmetry::AnySym || (row_spans.size() == 1 && column_spans.size() == 1))
+		return generate_backtracking(sym, selection, base_glyphs, stop, progress, statistics);
 
+	/// The regions are generated in phases, by how many seams they lie on: the blocks, then the seams between two blocks, then the crossings between four.
+	///	No two regions in the same phase touch, so they never depend on each other, and each region touches some region of a later phase, which is still empty.
+	///	The regions of the last phase are surrounded, so they are kept in a path instead, which snakes through them a row at a time, see below.
+	struct Region
+	{
+		Selection selection;
+		bool seam_rows;    ///< Whether the region lies on a seam between blocks above and below it
+		bool seam_columns; ///< Whether the region lies on a seam between blocks to its left and right
+		Selection bounds;  ///< How far a margin around the region may reach
+	};
+	const std::size_t last = (row_spans.size() > 1) + (column_spans.size() > 1);
+	std::array<std::vector<Region>, 2> phases;
+	std::vector<Region> path;
+	bool forward = true;
+	for (const Span& rows : row_spans)
+	{
+		std::vector<Region> band;
+		for (const Span& columns : column_spans)
+		{
+			const Region region = { { { rows.min, columns.min }, { rows.max, columns.max } }, rows.seam, columns.seam, selection };
+			const std::size_t phase = rows.seam + columns.seam;
+			if (phase == last)
+				band.push_back(region);
+			else
+				phases[phase].push_back(region);
+		}
+		if (band.empty())
+			continue;
+		if (!forward)
+			std::ranges::reverse(band);
+		path.insert(path.end(), band.begin(), band.end());
+		forward = !forward;
+	}
+
+	const int region_count = static_cast<int>(phases[0].size() + phases[1].size() + path.size());
 	const wxString& prefix = status_prefix(sym);
+	const auto report = [&](int regions) { if (progress) progress(wxString::Format("%sRegion %i/%i", prefix, regions, region_count)); };
+
+	/// Each region is posed as a \c Problem of its own, around whatever has been generated so far, and written straight into \c glyphs.
+	///	The runs of every region are counted together, along with how many regions each \c RestartSchedule won.
+	Glyphs glyphs = base_glyphs;
+	std::atomic<int> runs = 0;
+	std::array<std::atomic<int>, 2> wins = {};
+	const auto generate_region = [&](Selection region, Rng& rng)
+		{
+			const Problem problem(glyphs, region, Symmetry::AnySym, wrapXEnabled, wrapYEnabled, {}, weights.get());
+			if (problem.odd_strands())
+				return false;
+			Propagator propagator(problem);
+			if (!propagator.propagate())
+				return false;
 
-	/// Next, enter a loop, counting the number of attempts made at generating this knot. The steps are as follows.
-	for (int attempts = 1; attempts <= MAX_ATTEMPTS; attempts++) {
-		/// \b (1) At certain intervals of numbers of attempts, update the status bar with the number of attempts made.
-		if (attempts % ATTEMPTS_DISPLAY_INCREMENT == 0)
-			statusBar->SetStatusText(wxString::Format("%sAttempt %i/%i", prefix, attempts, MAX_ATTEMPTS));
+			RestartStatistics restarts;
+			const std::optional<std::vector<std::size_t>> values = solve_with_restarts(problem, propagator.domains(), rng, DIVIDE_REGION_BACKTRACKS, {}, stop, &restarts);
+			runs += restarts.runs;
+			if (!values)
+				return false;
+			++wins[restarts.winner == RestartSchedule::luby];
+			problem.place(glyphs, *values);
+			return true;
+		};
 
-		/// \b (2) Call Knot::tryGenerating() using the copy of \c glyphs created above.
-		///		If it fails, \c continue the loop and try again.
-		std::optional<Glyphs> newGlyphs = tryGenerating(base_glyphs, sym, selection);
-		if (!newGlyphs) continue;
+	/// The regions regenerated one after another share the first stream of \c seed, and each region generated alongside others has a stream of its own,
+	///	so that the knot does not depend on which worker generates which region.
+	Rng rng(*seed);
+	std::atomic<int> done = 0;
 
-		/// \b (3) If the knot has been successfully generated, set \c glyphs equal to this generated version and return \c true.
-		glyphs = *newGlyphs;
-		return true;
+	/// A region can fail when what was generated around it leaves it no options, so clear it along with a margin around it, and generate it again,
+	///	growing the margin until it succeeds. A seam only grows across itself, into the blocks on either side, so that it still touches the empty regions at its ends.
+	///	A block never grows, since it only touches empty seams and whatever was fixed before, so it always has a solution, and is simply searched again.
+	///	Where the margin runs past an edge of the selection which wraps, it carries on from the far edge. That part is generated first, while the rest is still empty around it.
+	///	A margin never reaches past the bounds of the region.
+	const auto regenerate = [&](const Region& region)
+		{
+			for (int margin = DIVIDE_SEAM_WIDTH; margin <= DIVIDE_BLOCK_SIZE && !stop.stop_requested(); margin += DIVIDE_SEAM_WIDTH)
+			{
+				const int margin_i = region.seam_rows ? margin : 0;
+				const int margin_j = region.seam_columns ? margin : 0;
+				const Selection& bounds = region.bounds;
+				const Selection grown =
+				{
+					{ std::max(bounds.min.i, region.selection.min.i - margin_i), std::max(bounds.min.j, region.selection.min.j - margin_j) },
+					{ std::min(bounds.max.i, region.selection.max.i + margin_i), std::min(bounds.max.j, region.selection.max.j + margin_j) },
+				};
+
+				std::vector<Selection> parts;
+				const int before_i = bounds.min.i - (region.selection.min.i - margin_i), after_i = region.selection.max.i + margin_i - bounds.max.i;
+				const int before_j = bounds.min.j - (region.selection.min.j - margin_j), after_j = region.selection.max.j + margin_j - bounds.max.j;
+				if (wraps_rows && bounds.min.i == selection.min.i && before_i > 0)
+					parts.push_back({ { selection.max.i - before_i + 1, grown.min.j }, { selection.max.i, grown.max.j } });
+				if (wraps_rows && bounds.max.i == selection.max.i && after_i > 0)
+					parts.push_back({ { selection.min.i, grown.min.j }, { selection.min.i + after_i - 1, grown.max.j } });
+				if (wraps_columns && bounds.min.j == selection.min.j && before_j > 0)
+					parts.push_back({ { grown.min.i, selection.max.j - before_j + 1 }, { grown.max.i, selection.max.j } });
+				if (wraps_columns && bounds.max.j == selection.max.j && after_j > 0)
+					parts.push_back({ { grown.min.i, selection.min.j }, { grown.max.i, selection.min.j + after_j - 1 } });
+
+				parts.push_back(grown);
+
+				for (const Selection part : parts)
+					glyphs.copy_selection(base_glyphs, part);
+				if (std::ranges::all_of(parts, [&](Selection part) { return generate_region(part, rng); }))
+					return true;
+			}
+			return false;
+		};
+
+	for (unsigned int phase = 0; phase < last; ++phase)
+	{
+		/// Then, for each phase but the last, share its regions out between the workers, each taking the next region until there are none left.
+		const std::vector<Region>& regions = phases[phase];
+		std::vector<char> failed(regions.size(), false);
+		std::atomic<std::size_t> next = 0;
+		const auto work = [&](bool reporting)
+			{
+				for (std::size_t index = next++; index < regions.size() && !stop.stop_requested(); index = next++)
+				{
+					Rng region_rng(*seed, (std::uint64_t{ phase + 1 } << 32) + index);
+					failed[index] = !generate_region(regions[index].selection, region_rng);
+					++done;
+					if (reporting)
+						report(done);
+				}
+			};
+
+		const int workers = std::min(worker_count, static_cast<int>(regions.size()));
+		if (workers <= 1)
+			work(true);
+		else
+		{
+			std::atomic<int> running = workers;
+			std::vector<std::jthread> threads;
+			for (int worker = 0; worker < workers; ++worker)
+				threads.emplace_back([&] { work(false); --running; });
+
+			while (running > 0)
+			{
+				std::this_thread::sleep_for(PARALLEL_DISPLAY_INTERVAL);
+				report(done);
+			}
+		}
+
+		if (stop.stop_requested())
+			return std::nullopt;
+
+		/// A region which an earlier margin has already covered is left as it is.
+		for (std::size_t index = 0; index < regions.size(); ++index)
+			if (failed[index] && std::ranges::any_of(SelectionRange(regions[index].selection), [&](Point p) { return !glyphs[p]; }) && !regenerate(regions[index]))
+				return std::nullopt;
 	}
-	/// \b (4) If this loop has been completed, then the maximum number of attempts have been tried. Therefore return \c false.
-	return false;
+
+	/// Lastly, follow the path. Every glyph has an even number of strand ends, so a region with an odd number of strands passing into it can never be generated,
+	///	however large a margin is cleared around it. Instead, such a region is generated along with the way to the next region on the path, once that has been cleared.
+	///	The next region then has one strand more or fewer passing into it, so an odd number is carried along the path until it meets another, and the two cancel out.
+	///	Any region which still fails is regenerated straight away, before the next one, which stays empty meanwhile. The last region is then left with an even number,
+	///	as long as the selection as a whole has one.
+	for (std::size_t index = 0; index < path.size() && !stop.stop_requested(); ++index)
+	{
+		Region region = path[index];
+		if (index + 1 < path.size() && Problem(glyphs, region.selection, Symmetry::AnySym, wrapXEnabled, wrapYEnabled).odd_strands())
+		{
+			/// The way to the next region is cleared too, and any margin is kept from reaching the next region.
+			const Selection next = path[index + 1].selection;
+			Selection& bounds = region.bounds;
+			Selection between;
+			if (region.selection.min.i != next.min.i)
+			{
+				between = { { region.selection.max.i + 1, region.selection.min.j }, { next.min.i - 1, region.selection.max.j } };
+				bounds.max.i = between.max.i;
+			}
+			else if (region.selection.max.j < next.min.j)
+			{
+				between = { { region.selection.min.i, region.selection.max.j + 1 }, { region.selection.max.i, next.min.j - 1 } };
+				bounds.max.j = between.max.j;
+			}
+			else
+			{
+				between = { { region.selection.min.i, next.max.j + 1 }, { region.selection.max.i, region.selection.min.j - 1 } };
+				bounds.min.j = between.min.j;
+			}
+			glyphs.copy_selection(base_glyphs, between);
+			region.selection = { { std::min(region.selection.min.i, between.min.i), std::min(region.selection.min.j, between.min.j) }, { std::max(region.selection.max.i, between.max.i), std::max(region.selection.max.j, between.max.j) } };
+		}
+		if (!generate_region(region.selection, rng) && !regenerate(region))
+			return std::nullopt;
+		report(++done);
+	}
+
+	if (stop.stop_requested())
+		return std::nullopt;
+	statistics.attempts = runs;
+	statistics.strategy = wxString::Format("Luby runs for %i of %i regions", static_cast<int>(wins[1]), static_cast<int>(wins[0] + wins[1]));
+	return glyphs;
+}
+
+std::optional<Glyphs> Knot::generate_sampling(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const
+/** Called only from Knot::generator(), generate the selection by drawing it uniformly at random from every knot which fits, see \c StripSampler.
+ *
+ * The other methods choose each glyph uniformly from those which fit so far, so a knot with fewer options along the way is more likely than one with many,
+ * and they can still reach a dead end. Counting first means that every knot which fits is equally likely, and that drawing one never fails.
+ * Counting is only possible for a strip a few tiles wide, so a wider selection is generated by Knot::generate_backtracking() instead.
+ */
+{
+	/// First, pose the selection as a \c Problem, and propagate the fixed glyphs and edges once, as in Knot::generate_propagating().
+	const Problem problem(base_glyphs, selection, sym, wrapXEnabled, wrapYEnabled, pattern);
+
+	Propagator initial(problem);
+	if (!initial.propagate())
+		return std::nullopt;
+
+	const wxString& prefix = status_prefix(sym);
+	Rng rng(*seed);
+
+	/// Next, count the knots, reporting how far counting has got as it goes.
+	StripSampler sampler(problem, initial.domains());
+	StripSampler::Progress report;
+	if (progress)
+		report = [&](int steps, int total) { progress(wxString::Format("%sCounting %i/%i", prefix, steps, total)); };
+	if (!sampler.count(report, stop))
+	{
+		if (stop.stop_requested())
+			return std::nullopt;
+		return generate_backtracking(sym, selection, base_glyphs, stop, progress, statistics);
+	}
+
+	/// Lastly, draw one of them.
+	const std::optional<std::vector<std::size_t>> values = sampler.sample(rng);
+	if (!values)
+		return std::nullopt;
+	return problem.solution(base_glyphs, *values);
 }
 
-std::optional<Glyphs> Knot::tryGenerating(Glyphs glyphGrid, Symmetry sym, Selection selection) const
-/** Called only from Knot::generate(), try generating a knot with the given symmetry for the given selection.
+Knot::FeasibilityCheck Knot::feasibility(Symmetry sym, Selection selection, const Tiles& tiles) const
+/** Prepare to check whether any knot with the given symmetry can be generated in the given selection, without generating it, see check_feasibility().
+ * Deciding takes milliseconds, rather than the whole of \c time_budget that Knot::generate() would spend before giving up,
+ * but explaining why a knot is impossible can take longer, so as with Knot::generator(), everything needed is copied here, and the check can run on another thread.
+ */
+{
+	return [base_glyphs = make_base_glyphs(sym, selection, tiles), selection, sym, wrap_x = wrapXEnabled, wrap_y = wrapYEnabled, pattern = pattern](std::stop_token stop)
+		{
+			return check_feasibility(Problem(base_glyphs, selection, sym, wrap_x, wrap_y, pattern), stop);
+		};
+}
+
+Knot::Counter Knot::count_knots(Symmetry sym, Selection selection, const Tiles& tiles) const
+/** Prepare to count the knots with the given symmetry which fit the given selection and its locked tiles, see count_solutions().
+ * A narrow strip is counted exactly however many knots it has, and anything else is listed, each for at most \c COUNT_TIME_BUDGET.
+ * As with Knot::generator(), everything needed is copied here, so that the count can run on another thread.
+ */
+{
+	return [base_glyphs = make_base_glyphs(sym, selection, tiles), selection, sym, wrap_x = wrapXEnabled, wrap_y = wrapYEnabled, pattern = pattern](std::stop_token stop)
+		{
+			const Problem problem(base_glyphs, selection, sym, wrap_x, wrap_y, pattern);
+			return count_solutions(problem, problem.domains, COUNT_TIME_BUDGET, stop);
+		};
+}
+
+template <Symmetry sym>
+bool Knot::tryGenerating(Glyphs& glyphGrid, const Glyphs& base_glyphs, const OrbitTable& orbits, Rng& rng) const
+/** Called only from Knot::generate_restarting(), try generating a knot with the symmetry \c sym for the selection of \c orbits.
  * 
- * This function pulls the required logic in Knot::generate() in order to generate the Knot selection once, and places it into its own function. 
+ * This function pulls the required logic in Knot::generator() in order to generate the Knot selection once, and places it into its own function. 
+ *
+ * The same conditions apply as in the first paragraph of Knot::generator().
  *
- * The same conditions apply as in the first paragraph of Knot::generate().
+ * The \c base_glyphs variable is supplied from Knot::generator(), with \c nullptr entries for the unlocked cells of the selection.
+ * Only the selection of \c glyphGrid is reset to match it, so that \c glyphGrid can be reused from one attempt to the next without allocating.
+ * All of the randomness comes from \c rng, so that attempts on different threads are independent.
  *
- * The \c glyphGrid variable is supplied from Knot::generate(), already initialized with \c nullptr entries for the selection.
+ * There is one instantiation for each symmetry, so that the parts of each cell's work which the symmetry does not need are compiled out,
+ * rather than being tested for at every cell. With \c Symmetry::AnySym, no flags or images are left at all.
+ * Only the representative of each orbit is visited, and its images are written from the table in \c orbits, which is made once for all of the attempts.
  *
  * \b Method
  */
 {
 	/// First, start by creating constant \c bool and \c int values to use in the generating.
-	/// This includes deconstructing the \c Symmetry into its component bit flags,
+	/// This includes deconstructing the \c Symmetry into its component bit flags at compile time,
 	/// storing whether the selection compasses all rows or columns in the Knot,
 	/// storing the middle \c i and \c j indices of the selection,
 	/// and storing the wrapping conditions.
-	const bool bitHori = sym % Symmetry::HoriSym;
-	const bool bitVert = sym % Symmetry::VertSym;
-	const bool bitRot2 = sym % Symmetry::Rot2Sym;
-	const bool bitRot4 = sym % Symmetry::Rot4Sym;
-	const bool bitFwDi = sym % Symmetry::FwdDiag;
-	const bool bitBkDi = sym % Symmetry::BackDiag;
+	constexpr bool bitHori = sym % Symmetry::HoriSym;
+	constexpr bool bitVert = sym % Symmetry::VertSym;
+	constexpr bool bitRot2 = sym % Symmetry::Rot2Sym;
+	constexpr bool bitRot4 = sym % Symmetry::Rot4Sym;
+	constexpr bool bitFwDi = sym % Symmetry::FwdDiag;
+	constexpr bool bitBkDi = sym % Symmetry::BackDiag;
 
+	const Selection selection = orbits.selection;
 	const bool isEvenRows = (selection.max.i - selection.min.i + 1) % 2 == 0;
 	const bool isEvenCols = (selection.max.j - selection.min.j + 1) % 2 == 0;
 	const bool isAllRows = selection.min.i == 0 && selection.max.i == size.rows - 1;
@@ -99,77 +754,81 @@ std::optional<Glyphs> Knot::tryGenerating(Glyphs glyphGrid, Symmetry sym, Select
 	const GlyphFlag midVertFlag = isEvenCols ? GlyphFlag::CT_MIRR : GlyphFlag::SA_MIRY;
 	const GlyphFlag midRot2Flag = isEvenRows ? (isEvenCols ? GlyphFlag::NONE : GlyphFlag::CT_ROT2D) : (isEvenCols ? GlyphFlag::CT_ROT2R : GlyphFlag::SA_ROT2);
 	
-	const bool isSquare = bitRot4 || bitFwDi || bitBkDi;
+	constexpr bool isSquare = bitRot4 || bitFwDi || bitBkDi;
 	const GlyphFlag midRot4Flag = isSquare ? (isEvenRows ? GlyphFlag::CT_ROT4R : !isEvenRows ? GlyphFlag::SA_ROT4 : GlyphFlag::NONE) : GlyphFlag::NONE;
 	const GlyphFlag selfFlag = (GlyphFlag::CT_SELFD * (size.rows == 1)) | (GlyphFlag::CT_SELFR * (size.columns == 1)); // If this selection is only 1 row in length in either direction, flag appropriately
 	
 	const bool doWrapX = wrapXEnabled && (!isSquare || wrapYEnabled);
 	const bool doWrapY = wrapYEnabled && (!isSquare || wrapXEnabled);
 
-	/// Next, enter a loop over each location in the selection. Do the following.
-	for (int i = selection.min.i, iOffset = 0; i <= selection.max.i; i++, iOffset++) {
-		for (int j = selection.min.j, jOffset = 0; j <= selection.max.j; j++, jOffset++) {
-			/// \b (1) If the Glyph in this location is already set, \c continue the loop.
-			if (glyphGrid[i][j]) continue;
-
-			/// \b (2) If the Glyph has yet to be set, generate a random \c Glyph for this location, with the \c GlyphFlag::NONE flag.
-			///	For each of the 4 \c Connection parameters, there are many possible cases, implemented in a large nested ternary operation, described below.
-			glyphGrid[i][j] = Glyph::Random(
-				/** (a) If this Glyph location is on the outer edge of the selection on this particular side, branch to condition B, otherwise branch to condition E.
-				 *
-				 *	(b) If wrapping is not enabled in this direction, then the parameter should be \c Connection::EMPTY.
-				 *	(c) If the Glyph directly on the other end of the wrap is not assigned, then the parameter should be \c Connection::DO_NOT_CARE.
-				 *	(d) In the general wrapping case, where none of the other special wrapping cases apply, the parameter should be
-				 *		the connection on the opposite side of the glyph on the other end of the wrap.
-				 *
-				 *	(e) If the next glyph on this particular side is not yet assigned, the parameter should be \c Connection::DO_NOT_CARE.
-				 *	(f) In the general case, where none of the other special cases apply, the parameter should be
-				 *		the connection on the opposite side, from the neighbouring glyph on this particular side.
-				 */
-				{
-					i == 0		? (!doWrapY ? Connection::EMPTY : !glyphGrid[size.rows - 1][j]	? Connection::DO_NOT_CARE : glyphGrid[size.rows - 1][j]->down)	: (!glyphGrid[i - 1][j] ? Connection::DO_NOT_CARE : glyphGrid[i - 1][j]->down	) ,
-					i == size.rows - 1	? (!doWrapY ? Connection::EMPTY : !glyphGrid[0][j]		? Connection::DO_NOT_CARE : glyphGrid[0][j]->up)		: (!glyphGrid[i + 1][j] ? Connection::DO_NOT_CARE : glyphGrid[i + 1][j]->up		) ,
-					j == 0		? (!doWrapX ? Connection::EMPTY : !glyphGrid[i][size.columns - 1]	? Connection::DO_NOT_CARE : glyphGrid[i][size.columns - 1]->right) : (!glyphGrid[i][j - 1] ? Connection::DO_NOT_CARE : glyphGrid[i][j - 1]->right	) ,
-					j == size.columns - 1	? (!doWrapX ? Connection::EMPTY : !glyphGrid[i][0]		? Connection::DO_NOT_CARE : glyphGrid[i][0]->left)		: (!glyphGrid[i][j + 1] ? Connection::DO_NOT_CARE : glyphGrid[i][j + 1]->left	)
-				},
-				/** The \c boolFlags argument in Glyph::Random() has different components added, under various conditions. 
-				 *  (a) If this type of symmetry includes horizontal reflection, then add \c GlyphFlag::CT_MIRU, only if the selection encompasses all rows and if the current location is in the uppermost row of the Knot.
-				 *  (b) If this type of symmetry includes horizontal reflection but this time the current operation is in the middle row, then add either \c GlyphFlag::CT_MIRD or \c GlyphFlag::SA_MIRX depending on parity.
-				 *  (c) If this type of symmetry includes vertical reflection, then add \c GlyphFlag::CT_MIRL, only if the selection encompasses all columns and if the current location is in the leftmost column of the Knot.
-				 *  (d) If this type of symmetry includes vertical reflection but this time the current operation is in the middle column, then add either \c GlyphFlag::CT_MIRR or \c GlyphFlag::SA_MIRY depending on parity.
-				 *  (e) If this type of symmetry includes 2-way rotation and the current operation is in the middle row and middle column, then add either \c GlyphFlag::CT_ROT2D, \c GlyphFlag::CT_ROT2R, or \c GlyphFlag::SA_ROT2, depending on the parities.
-				 *  (f) If this type of symmetry includes 4-way rotation and the current operation is in the middle row and middle column, then add either \c GlyphFlag::CT_ROT4R or \c GlyphFlag::SA_ROT4 depending on the parity.
-				 *  (g) If this type of symmetry includes back diagonal reflection, then add \c GlyphFlag::SA_MIRBD, only if the \c i offset and the \c j offset are equal, meaning that the location is along the diagonal.
-				 *  (h) If this selection is only 1 row in height, add GlyphFlag::CT_SELFD.
-				 *  (i) If this selection is only 1 column in width, add GlyphFlag::CT_SELFR.
-				 */
-				(
-					(GlyphFlag::CT_MIRU  * (bitHori && isAllRows && i == 0)) | 
-					(midHoriFlag         * (bitHori && i == iMid)) | 
-					(GlyphFlag::CT_MIRL  * (bitVert && isAllCols && j == 0)) |
-					(midVertFlag         * (bitVert && j == jMid)) |
-					(midRot2Flag         * (bitRot2 && i == iMid && j == jMid)) |
-					(midRot4Flag         * (bitRot4 && i == iMid && j == jMid)) |
-					(GlyphFlag::SA_MIRBD * (bitBkDi && isSquare && iOffset == jOffset)) |
-					(selfFlag)
-				)
-			);
-
-			/// \b (3) If this newly generated Glyph turns out to be \c nullptr, then there were no options for this location. Return \c std::nullopt.
-			if (!glyphGrid[i][j]) return std::nullopt;
-
-			/// \b (4) If the function has made it to this point, then reflect and rotate the newly generated Glyph to the appropriate spots given the symmetry required.
-			if (bitHori) glyphGrid[selection.max.i - iOffset][j] = glyphGrid[i][j]->mirror_x;
-			if (bitVert) glyphGrid[i][selection.max.j - jOffset] = glyphGrid[i][j]->mirror_y;
-			if (bitRot2) glyphGrid[selection.max.i - iOffset][selection.max.j - jOffset] = glyphGrid[i][j]->rotate_180;
-			if (bitRot4) { glyphGrid[selection.min.i + jOffset][selection.max.j - iOffset] = glyphGrid[i][j]->rotate_90; glyphGrid[selection.max.i - jOffset][selection.min.j + iOffset] = glyphGrid[i][j]->rotate_270; }
-			if (bitFwDi) glyphGrid[selection.max.i - jOffset][selection.max.j - iOffset] = glyphGrid[i][j]->mirror_forward_diagonal;
-			if (bitBkDi) glyphGrid[selection.min.i + jOffset][selection.min.j + iOffset] = glyphGrid[i][j]->mirror_backward_diagonal;
-		}
+	/// Next, reset the selection to the locked glyphs from \c base_glyphs, left over from any earlier attempt.
+	glyphGrid.copy_selection(base_glyphs, selection);
+
+	/// Then, enter a loop over the representative of each orbit, in raster order. Do the following.
+	for (std::size_t orbit = 0; orbit < orbits.size(); orbit++) {
+		const auto [i, j] = orbits.representative(orbit);
+		const int iOffset = i - selection.min.i;
+		const int jOffset = j - selection.min.j;
+
+		/// \b (1) If the Glyph in this location is already set, it was locked along with its images, so \c continue the loop.
+		if (glyphGrid[{ i, j }]) continue;
+
+		/// \b (2) If the Glyph has yet to be set, generate a random \c Glyph for this location, with the \c GlyphFlag::NONE flag.
+		///	For each of the 4 \c Connection parameters, there are many possible cases, implemented in a large nested ternary operation, described below.
+		const Glyph* glyph = Glyph::Random(
+			/** (a) If this Glyph location is on the outer edge of the selection on this particular side, branch to condition B, otherwise branch to condition E.
+			 *
+			 *	(b) If wrapping is not enabled in this direction, then the parameter should be \c Connection::EMPTY.
+			 *	(c) If the Glyph directly on the other end of the wrap is not assigned, then the parameter should be \c Connection::DO_NOT_CARE.
+			 *	(d) In the general wrapping case, where none of the other special wrapping cases apply, the parameter should be
+			 *		the connection on the opposite side of the glyph on the other end of the wrap.
+			 *
+			 *	(e) If the next glyph on this particular side is not yet assigned, the parameter should be \c Connection::DO_NOT_CARE.
+			 *	(f) In the general case, where none of the other special cases apply, the parameter should be
+			 *		the connection on the opposite side, from the neighbouring glyph on this particular side.
+			 */
+			{
+				i == 0		? (!doWrapY ? Connection::EMPTY : !glyphGrid[{ size.rows - 1, j }]	? Connection::DO_NOT_CARE : glyphGrid[{ size.rows - 1, j }]->down)	: (!glyphGrid[{ i - 1, j }] ? Connection::DO_NOT_CARE : glyphGrid[{ i - 1, j }]->down	) ,
+				i == size.rows - 1	? (!doWrapY ? Connection::EMPTY : !glyphGrid[{ 0, j }]		? Connection::DO_NOT_CARE : glyphGrid[{ 0, j }]->up)		: (!glyphGrid[{ i + 1, j }] ? Connection::DO_NOT_CARE : glyphGrid[{ i + 1, j }]->up		) ,
+				j == 0		? (!doWrapX ? Connection::EMPTY : !glyphGrid[{ i, size.columns - 1 }]	? Connection::DO_NOT_CARE : glyphGrid[{ i, size.columns - 1 }]->right) : (!glyphGrid[{ i, j - 1 }] ? Connection::DO_NOT_CARE : glyphGrid[{ i, j - 1 }]->right	) ,
+				j == size.columns - 1	? (!doWrapX ? Connection::EMPTY : !glyphGrid[{ i, 0 }]		? Connection::DO_NOT_CARE : glyphGrid[{ i, 0 }]->left)		: (!glyphGrid[{ i, j + 1 }] ? Connection::DO_NOT_CARE : glyphGrid[{ i, j + 1 }]->left	)
+			},
+			/** The \c boolFlags argument in Glyph::Random() has different components added, under various conditions. 
+			 *  (a) If this type of symmetry includes horizontal reflection, then add \c GlyphFlag::CT_MIRU, only if the selection encompasses all rows and if the current location is in the uppermost row of the Knot.
+			 *  (b) If this type of symmetry includes horizontal reflection but this time the current operation is in the middle row, then add either \c GlyphFlag::CT_MIRD or \c GlyphFlag::SA_MIRX depending on parity.
+			 *  (c) If this type of symmetry includes vertical reflection, then add \c GlyphFlag::CT_MIRL, only if the selection encompasses all columns and if the current location is in the leftmost column of the Knot.
+			 *  (d) If this type of symmetry includes vertical reflection but this time the current operation is in the middle column, then add either \c GlyphFlag::CT_MIRR or \c GlyphFlag::SA_MIRY depending on parity.
+			 *  (e) If this type of symmetry includes 2-way rotation and the current operation is in the middle row and middle column, then add either \c GlyphFlag::CT_ROT2D, \c GlyphFlag::CT_ROT2R, or \c GlyphFlag::SA_ROT2, depending on the parities.
+			 *  (f) If this type of symmetry includes 4-way rotation and the current operation is in the middle row and middle column, then add either \c GlyphFlag::CT_ROT4R or \c GlyphFlag::SA_ROT4 depending on the parity.
+			 *  (g) If this type of symmetry includes back diagonal reflection, then add \c GlyphFlag::SA_MIRBD, only if the \c i offset and the \c j offset are equal, meaning that the location is along the diagonal.
+			 *  (h) If this selection is only 1 row in height, add GlyphFlag::CT_SELFD.
+			 *  (i) If this selection is only 1 column in width, add GlyphFlag::CT_SELFR.
+			 */
+			(
+				(GlyphFlag::CT_MIRU  * (bitHori && isAllRows && i == 0)) | 
+				(midHoriFlag         * (bitHori && i == iMid)) | 
+				(GlyphFlag::CT_MIRL  * (bitVert && isAllCols && j == 0)) |
+				(midVertFlag         * (bitVert && j == jMid)) |
+				(midRot2Flag         * (bitRot2 && i == iMid && j == jMid)) |
+				(midRot4Flag         * (bitRot4 && i == iMid && j == jMid)) |
+				(GlyphFlag::SA_MIRBD * (bitBkDi && isSquare && iOffset == jOffset)) |
+				(selfFlag)
+			),
+			rng,
+			weights.get()
+		);
+
+		/// \b (3) If this newly generated Glyph turns out to be \c nullptr, then there were no options for this location. Return \c false.
+		if (!glyph) return false;
+		glyphGrid.set({ i, j }, glyph);
+
+		/// \b (4) If the function has made it to this point, then reflect and rotate the newly generated Glyph to each of its images given the symmetry required.
+		for (const OrbitImage& image : orbits.images(orbit))
+			glyphGrid.set(image.point, glyph->*GlyphsTransformed::member(image.transform));
 	}
 
 	/// \b (5) If the loop finishes, then the Knot has been successfully generated. Return \c true.
-	return { std::move(glyphGrid) };
+	return true;
 }
 
 Glyphs Knot::make_base_glyphs(const Symmetry sym, const Selection selection, const Tiles& tiles) const
@@ -180,45 +839,37 @@ Glyphs Knot::make_base_glyphs(const Symmetry sym, const Selection selection, con
 	for (int i = selection.min.i; i <= selection.max.i; i++)
 	for (int j = selection.min.j; j <= selection.max.j; j++)
 	{
-		if (tiles[i][j].locked())
-			base_glyphs[i][j] = glyphs[i][j];
-		else
-			base_glyphs[i][j] = nullptr;
+		if (!tiles[i][j].locked())
+			base_glyphs.set({ i, j }, nullptr);
 	}
 
-	const auto transform = [&](const Symmetry desired_sym, const CornerMovement type1, const CornerMovement type2, const Glyph* GlyphsTransformed::* transformation) -> void
-		{
-			if (!(sym % desired_sym))
-				return;
-	
-			for (const auto& [p1, p2] : SelectionZipRange{ selection, type1, type2 })
-			{
-				/// If a tile is locked and its transformed tile is not locked, also lock the transformed tile
-				const Tile& t1 = tiles[p1.i][p1.j];
-				const Tile& t2 = tiles[p2.i][p2.j];
-				if (t1.locked() && !t2.locked())
-				{
-					base_glyphs[p2.i][p2.j] = base_glyphs[p1.i][p1.j]->*transformation;
-				}
-				else if (!t1.locked() && t2.locked())
-				{
-					base_glyphs[p1.i][p1.j] = base_glyphs[p2.i][p2.j]->*(GlyphsTransformed::inverse(transformation));
-				}
-			}
-		};
+	if (sym == Symmetry::AnySym)
+		return base_glyphs;
 
-	using enum Corner;
-	using enum Movement;
-
-	transform(Symmetry::HoriSym, (upper_left | right), (lower_left | right), &Glyph::mirror_x);
-	transform(Symmetry::VertSym, (upper_left | down), (upper_right | down), &Glyph::mirror_y);
-
-	transform(Symmetry::Rot2Sym, (upper_left | right), (lower_right | left), &Glyph::rotate_180);
-	transform(Symmetry::Rot4Sym, (upper_left | right), (lower_left | up), &Glyph::rotate_90);
-	transform(Symmetry::Rot4Sym, (upper_left | right), (upper_right | down), &Glyph::rotate_90);
+	/// Then, for each orbit of the symmetry with a locked tile, work out the glyph of its representative from that tile, and set each unlocked tile of the orbit from it.
+	///	The locked tiles of an orbit all agree whenever the symmetry is allowed, see check_symmetry(), so it does not matter which one is used.
+	const OrbitTable orbits(sym, selection);
+	const auto is_locked = [&](Point p) { return tiles[p.i][p.j].locked(); };
+	for (std::size_t orbit = 0; orbit < orbits.size(); orbit++)
+	{
+		const Point representative = orbits.representative(orbit);
+		const Glyph* glyph = is_locked(representative) ? base_glyphs[representative] : nullptr;
+		for (const OrbitImage& image : orbits.images(orbit))
+		{
+			if (!glyph && is_locked(image.point))
+				glyph = base_glyphs[image.point]->*GlyphsTransformed::member(inverse(image.transform));
+		}
+		if (!glyph)
+			continue;
 
-	transform(Symmetry::FwdDiag, (upper_left | right), (lower_right | up), &Glyph::mirror_forward_diagonal);
-	transform(Symmetry::BackDiag, (upper_right | left), (lower_left | up), &Glyph::mirror_backward_diagonal);
+		if (!is_locked(representative))
+			base_glyphs.set(representative, glyph);
+		for (const OrbitImage& image : orbits.images(orbit))
+		{
+			if (!is_locked(image.point))
+				base_glyphs.set(image.point, glyph->*GlyphsTransformed::member(image.transform));
+		}
+	}
 
 	return base_glyphs;
 }
@@ -229,12 +880,12 @@ bool Knot::checkWrapping(Selection selection) const {
 		// Only do the check if the selection either includes the top or bottom row, but not both
 		if (selection.min.i == 0 && selection.max.i != size.rows - 1) {
 			for (int j = selection.min.j; j <= selection.max.j; j++)
-				if (glyphs[selection.min.i][j]->up != Connection::EMPTY)
+				if (glyphs[{ selection.min.i, j }]->up != Connection::EMPTY)
 					return false;
 		}
 		else if (selection.min.i != 0 && selection.max.i == size.rows - 1) {
 			for (int j = selection.min.j; j <= selection.max.j; j++)
-				if (glyphs[selection.max.i][j]->down != Connection::EMPTY)
+				if (glyphs[{ selection.max.i, j }]->down != Connection::EMPTY)
 					return false;
 		}
 	}
@@ -244,12 +895,12 @@ bool Knot::checkWrapping(Selection selection) const {
 		// Only do the check if the selection either includes the left or right column, but not both
 		if (selection.min.j == 0 && selection.max.j != size.columns - 1) {
 			for (int i = selection.min.i; i <= selection.max.i; i++)
-				if (glyphs[i][selection.min.j]->left != Connection::EMPTY)
+				if (glyphs[{ i, selection.min.j }]->left != Connection::EMPTY)
 					return false;
 		}
 		else if (selection.min.j != 0 && selection.max.j == size.columns - 1) {
 			for (int i = selection.min.i; i <= selection.max.i; i++)
-				if (glyphs[i][selection.max.j]->right != Connection::EMPTY)
+				if (glyphs[{ i, selection.max.j }]->right != Connection::EMPTY)
 					return false;
 		}
 	}
@@ -257,9 +908,13 @@ bool Knot::checkWrapping(Selection selection) const {
 	return true;
 }
 
-Symmetry Knot::symmetry_of(Selection selection, const Tiles& tiles) const
+Symmetry Knot::symmetry_of(Selection selection, const Tiles& tiles)
+/** The symmetries which the locked tiles and the glyphs around \c selection allow, as check_symmetry() finds them.
+ *
+ * Asking again about the same selection only checks what has changed since, as long as every change of locking is passed to Knot::lock_changed() or Knot::locking_changed().
+ */
 {
-	return check_symmetry(glyphs, tiles, selection, size);
+	return symmetry_tracker.symmetry(glyphs, tiles, selection, size);
 }
 
 wxString Knot::plaintext() const
@@ -1,35 +1,107 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <stop_token>
 #include "Forward.h"
+#include "pure/GlyphGrid.h"
 #include "pure/GridSize.h"
+#include "pure/Pattern.h"
+#include "pure/Symmetry.h"
+
+/// The ways in which Knot::generate() can fill a selection
+enum class GenerationMethod
+{
+	restarts,       ///< Fill the selection in raster order with Knot::tryGenerating(), starting over whenever a cell has no options
+	propagation,    ///< Pose the selection as a \c Problem, and narrow every domain after each random choice, see \c Propagator
+	fewest_options, ///< As \c propagation, but always choosing next for the orbit with the fewest glyphs left, see Propagator::fill_fewest_first()
+	backtracking,   ///< Pose the selection as a \c Problem, and search it depth-first, jumping back to the cause of each dead end, see \c Backtracker
+	repair,         ///< Pose the selection as a \c Problem, fill it all in, then change only the orbits which do not fit until they all do, see \c Repairer
+	divide,         ///< Generate blocks of the selection in parallel by backtracking, then the seams between them, see Knot::generate_dividing()
+	uniform,        ///< Count every knot which fits a narrow strip, and draw one of them uniformly at random, see \c StripSampler
+};
 
 /** This class represents a knot object as a grid of glyphs, with corresponding public functions to generate various symmetries. */
 class Knot
 {
 public:
-	Knot(GridSize size, wxStatusBar* statusBar);
-	Knot(Glyphs&& glyphs, wxStatusBar* statusBar);
+	explicit Knot(GridSize size);
+	explicit Knot(Glyphs&& glyphs);
 	wxUniChar get(const int i, const int j) const;
 	CodePoint code_point(const int i, const int j) const;
 
 	GridSize size;                  ///< The size of the knot
-	wxStatusBar* const statusBar;	///< The \c wxStatusBar object from the MainWindow class where the knot should output its progress while generating a knot
 	bool wrapXEnabled = false;		///< Is wrapping enabled in the X direction
 	bool wrapYEnabled = false;		///< Is wrapping enabled in the Y direction
+	GenerationMethod method = GenerationMethod::propagation; ///< How Knot::generate() fills the selection
+	int worker_count = 1;           ///< The number of threads working at once in Knot::generate(), for the methods which make independent attempts or divide the selection
+	std::chrono::milliseconds time_budget = GENERATE_TIME_BUDGET; ///< How long a \c Generator keeps trying before giving up, as if it had been stopped
+	Pattern pattern;                ///< How Knot::generate() repeats the knot across the selection, generating only one fundamental tile of it
+	std::optional<std::uint64_t> seed; ///< The seed of every random choice made by Knot::generator(), or \c std::nullopt to draw a fresh one for each knot, see \c Rng
+	std::shared_ptr<PatchCache> patches; ///< The patches which Knot::generator() reuses and stores when rerolling, or \c nullptr to always generate afresh
+	std::shared_ptr<const GlyphWeights> weights; ///< How likely each glyph is to be chosen by Knot::generate(), or \c nullptr for every glyph equally likely, which uniform sampling always is
+
+	/// Called with a status message saying how far generating has got, on the thread which is generating
+	using Progress = std::function<void(const wxString& status)>;
+	/// What a \c Generator did to make its knot, to be shown once it finishes
+	struct Statistics
+	{
+		int attempts = 0;         ///< The attempts started over from scratch, the runs of the backtracking search, or the orbits changed by local repair
+		int partial_restarts = 0; ///< The times an attempt started over only around where it failed, see Propagator::restart_near_failure()
+		wxString strategy;        ///< What found the knot, such as which \c RestartSchedule won, or empty if there was only one way to find it
+		std::chrono::steady_clock::duration elapsed{};
+		bool timed_out = false;   ///< Whether \c time_budget ran out before a knot was found, rather than the method giving up or showing that none fits
+	};
+	/// A knot made by a \c Generator, or if none was, how it failed
+	struct Generated
+	{
+		std::optional<Glyphs> glyphs;      ///< The whole grid of glyphs, or \c std::nullopt if generating failed or was stopped
+		std::optional<std::uint64_t> seed; ///< The seed which generates the same knot again, or \c std::nullopt if it was a patch taken from \c patches
+		Statistics statistics;
+	};
+	/// Generates the whole grid of glyphs from a copy of a Knot, stopping early if asked to, see Knot::generator()
+	using Generator = std::function<Generated(std::stop_token stop, const Progress& progress)>;
+	/// Checks whether a knot can be generated at all from a copy of a Knot, see Knot::feasibility()
+	using FeasibilityCheck = std::function<FeasibilityReport(std::stop_token stop)>;
+	/// Counts knots from a copy of a Knot, see Knot::count_knots()
+	using Counter = std::function<SolutionCount(std::stop_token stop)>;
 
 	void clear(Selection selection, const Tiles& tiles);
 	bool generate(Symmetry sym, Selection selection, const Tiles& tiles);
+	Generator generator(Symmetry sym, Selection selection, const Tiles& tiles) const;
+	void set_glyphs(Glyphs&& newGlyphs);
+	FeasibilityCheck feasibility(Symmetry sym, Selection selection, const Tiles& tiles) const;
+	Counter count_knots(Symmetry sym, Selection selection, const Tiles& tiles) const;
 
 	bool checkWrapping(Selection selection) const;
 
-	Symmetry symmetry_of(Selection selection, const Tiles& tiles) const;
+	Symmetry symmetry_of(Selection selection, const Tiles& tiles);
+	void lock_changed(Point point, const Tiles& tiles) { symmetry_tracker.lock_changed(glyphs, tiles, point); } ///< Called after locking or unlocking one tile, see SymmetryTracker::lock_changed()
+	void locking_changed() { symmetry_tracker.reset(); } ///< Called after locking or unlocking many tiles at once, so that Knot::symmetry_of() checks every tile again
 
 	wxString plaintext() const;
 
 private:
 	Glyphs glyphs;	///< The current state of the Knot
+	SymmetryTracker symmetry_tracker; ///< The symmetries allowed in the selection last passed to Knot::symmetry_of(), kept up to date as the glyphs and locking change
 
-	std::optional<Glyphs> tryGenerating(Glyphs glyphGrid, Symmetry sym, Selection selection) const;
+	/// One independent attempt at generating into \c glyphs, which hold the new knot if it returns \c true, using only the given random engine,
+	/// and adding the number of times it started over only around where it failed to \c partial_restarts
+	using Attempt = std::function<bool(Rng& rng, Glyphs& glyphs, int& partial_restarts)>;
+	std::optional<Glyphs> make_attempts(Symmetry sym, const Glyphs& base_glyphs, const Attempt& attempt, std::stop_token stop, const Progress& progress, Statistics& statistics) const;
+
+	std::optional<Glyphs> generate_by_method(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const;
+	std::optional<Glyphs> generate_restarting(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const;
+	std::optional<Glyphs> generate_propagating(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const;
+	std::optional<Glyphs> generate_backtracking(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const;
+	std::optional<Glyphs> generate_repairing(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const;
+	std::optional<Glyphs> generate_dividing(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const;
+	std::optional<Glyphs> generate_sampling(Symmetry sym, Selection selection, const Glyphs& base_glyphs, std::stop_token stop, const Progress& progress, Statistics& statistics) const;
+
+	template <Symmetry sym>
+	bool tryGenerating(Glyphs& glyphGrid, const Glyphs& base_glyphs, const OrbitTable& orbits, Rng& rng) const;
 
 	Glyphs make_base_glyphs(Symmetry sym, Selection selection, const Tiles& tiles) const;
 
@@ -37,17 +109,15 @@ private:
 };
 
 /* Knot::Knot */
-/** \fn Knot::Knot(GridSize size, wxStatusBar* statusBar)
+/** \fn Knot::Knot(GridSize size)
  * Constructor for a Knot object with default data.
  * 
  * \param size The size of the knot, i.e. the number of rows and columns.
- * \param statusBar The \c wxStatusBar object from the MainWindow class where the knot should output its progress while generating a knot. This will usually be passed as GetStatusBar() when called.
  */
-/** \fn Knot::Knot(Glyphs&& glyphs, wxStatusBar* statusBar)
+/** \fn Knot::Knot(Glyphs&& glyphs)
  * Constructor for a Knot object with provided data.
  * 
  * \param glyphs The data with which to construct the Knot, not checking if any of the values are \c nullptr.
- * \param statusBar The \c wxStatusBar object from the MainWindow class where the knot should output its progress while generating a knot. This will usually be passed as GetStatusBar() when called.
  */
 /** \fn Knot::get(const int i, const int j) const
  * Accessor for the \c wxString representation of a Glyph.
@@ -57,6 +127,10 @@ private:
  * \return The \c wxString of the Glyph object at the (i,j) location of the knot 
  */
 
+/** \fn Knot::set_glyphs(Glyphs&& newGlyphs)
+ * Replace every glyph of the Knot at once, such as with the result of a \c Generator, which must be the same size.
+ */
+
 /** \fn Knot::checkWrapping(Selection selection)
  * Check if any of the previous wrapping conditions made it so that non wrapped knots cannot be generated.
  * 
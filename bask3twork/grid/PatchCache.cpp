@@ -0,0 +1,259 @@
+#include "pch.h"
+#include "grid/PatchCache.h"
+#include "pure/Glyph.h"
+#include "pure/Pattern.h"
+#include "pure/SelectionIterator.h"
+#include "pure/Symmetry.h"
+#include "solver/Problem.h"
+#include "Constants.h"
+
+namespace
+{
+	/// A side of a cell, along with the side of the neighbouring cell which faces it
+	struct Side
+	{
+		Movement outward;
+		Movement facing;
+	};
+
+	constexpr Side sides[] =
+	{
+		{ Movement::up,    Movement::down },
+		{ Movement::down,  Movement::up },
+		{ Movement::left,  Movement::right },
+		{ Movement::right, Movement::left },
+	};
+
+	constexpr char inside_marker = '\xFE'; ///< Keys a side whose neighbour is part of the selection itself, across a wrapped edge
+	constexpr char free_marker = '\xFF';   ///< Keys a side whose neighbour is still to be generated
+
+	/// Appends the low two bytes of \c value to \c key
+	void append(PatchCache::Key& key, int value)
+	{
+		key.push_back(static_cast<char>(value & 0xFF));
+		key.push_back(static_cast<char>((value >> 8) & 0xFF));
+	}
+
+	/// The number of bytes counted for each key, on top of its patches, for the list and map entries holding it
+	constexpr std::size_t entry_overhead = 128;
+}
+
+PatchCache::Key PatchCache::key_of(const Glyphs& base, Selection selection, Symmetry sym, const Pattern& pattern, bool wrap_x, bool wrap_y)
+{
+	return make_key(base, selection, sym, pattern, wrap_x, wrap_y, true);
+}
+
+PatchCache::Key PatchCache::make_key(const Glyphs& glyphs, Selection selection, Symmetry sym, const Pattern& pattern, bool wrap_x, bool wrap_y, bool locked_inside)
+/// As PatchCache::key_of(), but if \c locked_inside is \c false, every cell of the selection is taken to be free, whatever \c glyphs holds there.
+{
+	const GridSize size = glyphs.size();
+
+	/// First, the size of the selection, the symmetry and the pattern.
+	Key key;
+	append(key, selection.rows());
+	append(key, selection.columns());
+	append(key, static_cast<int>(sym));
+	append(key, static_cast<int>(pattern.repeat));
+	if (pattern.repeat != Repeat::none)
+	{
+		append(key, pattern.period.rows);
+		append(key, pattern.period.columns);
+	}
+
+	/// Then, each side of the selection, going round the cells on its boundary in raster order.
+	for (const Point p : SelectionRange(selection))
+		for (const Side side : sides)
+		{
+			Point q = p + Point::movement(side.outward);
+			if (selection.contains(q))
+				continue;
+
+			const bool off_rows = q.i < 0 || q.i >= size.rows;
+			const bool off_columns = q.j < 0 || q.j >= size.columns;
+			if ((off_rows && !wrap_y) || (off_columns && !wrap_x))
+			{
+				key.push_back(static_cast<char>(Connection::EMPTY));
+				continue;
+			}
+			q = { (q.i + size.rows) % size.rows, (q.j + size.columns) % size.columns };
+
+			if (selection.contains(q))
+				key.push_back(inside_marker);
+			else if (const Glyph* fixed = glyphs[q])
+				key.push_back(static_cast<char>(connection_of(index_of(fixed), Transform::identity, side.facing)));
+			else
+				key.push_back(free_marker);
+		}
+
+	/// Last, the glyph locked in each cell of the selection, if any.
+	for (const Point p : SelectionRange(selection))
+		key.push_back(static_cast<char>(locked_inside ? GlyphGrid::encode(glyphs[p]) : GlyphGrid::no_glyph));
+	return key;
+}
+
+std::vector<std::uint8_t> PatchCache::patch_of(const Glyphs& glyphs, Selection selection)
+{
+	std::vector<std::uint8_t> patch;
+	patch.reserve(selection.rows() * selection.columns());
+	for (const Point p : SelectionRange(selection))
+		patch.push_back(GlyphGrid::encode(glyphs[p]));
+	return patch;
+}
+
+PatchCache::Entry& PatchCache::entry_for(const Key& key)
+/// Finds the entry for \c key, adding an empty one if there is none, and moves it to the front of the list as the one used most recently.
+{
+	if (const auto found = index.find(key); found != index.end())
+	{
+		entries.splice(entries.begin(), entries, found->second);
+		return entries.front();
+	}
+
+	entries.push_front({ key, {}, 0, false });
+	index.emplace(key, entries.begin());
+	_bytes += 2 * key.size() + entry_overhead;
+	return entries.front();
+}
+
+bool PatchCache::add(Entry& entry, std::vector<std::uint8_t>&& patch)
+/** Adds \c patch to \c entry unless it is there already, replacing the oldest patch if the entry is full.
+ *
+ * \return Whether \c patch was added, rather than being there already
+ */
+{
+	if (std::ranges::find(entry.patches, patch) != entry.patches.end())
+		return false;
+
+	_bytes += patch.size();
+	if ((int)entry.patches.size() < PATCH_CACHE_VARIANTS)
+	{
+		entry.patches.push_back(std::move(patch));
+		entry.cycling |= (int)entry.patches.size() == PATCH_CACHE_VARIANTS;
+		return true;
+	}
+
+	_bytes -= entry.patches.front().size();
+	entry.patches.erase(entry.patches.begin());
+	entry.patches.push_back(std::move(patch));
+	entry.next = std::min(entry.next, entry.patches.size() - 1);
+	return true;
+}
+
+void PatchCache::evict()
+/// Drops the keys used least recently until the cache fits in \c PATCH_CACHE_BYTES, always keeping the one used most recently.
+{
+	while (_bytes > PATCH_CACHE_BYTES && entries.size() > 1)
+	{
+		const Entry& oldest = entries.back();
+		_bytes -= 2 * oldest.key.size() + entry_overhead;
+		for (const std::vector<std::uint8_t>& patch : oldest.patches)
+			_bytes -= patch.size();
+
+		index.erase(oldest.key);
+		entries.pop_back();
+	}
+}
+
+std::optional<Glyphs> PatchCache::take(const Key& key, const Glyphs& base, Selection selection, const Glyphs& current)
+{
+	std::scoped_lock lock(mutex);
+	if (!index.contains(key))
+		return std::nullopt;
+
+	Entry& entry = entry_for(key);
+	const std::vector<std::uint8_t> existing = patch_of(current, selection);
+
+	/// Once every patch has been handed out, only go round them again if the key has all of its variants, or has no more to be found, so that new ones are generated until then.
+	if (entry.next == entry.patches.size() && entry.cycling)
+		entry.next = 0;
+
+	while (entry.next < entry.patches.size())
+	{
+		const std::vector<std::uint8_t>& patch = entry.patches[entry.next++];
+		if (patch == existing)
+			continue;
+
+		Glyphs glyphs = base;
+		auto encoded = patch.begin();
+		for (const Point p : SelectionRange(selection))
+			glyphs.set(p, GlyphGrid::decode(*encoded++));
+		return glyphs;
+	}
+	return std::nullopt;
+}
+
+void PatchCache::store(const Key& key, const Glyphs& glyphs, Selection selection)
+{
+	std::scoped_lock lock(mutex);
+	Entry& entry = entry_for(key);
+	if (!add(entry, patch_of(glyphs, selection)))
+		entry.cycling = true;
+	entry.next = entry.patches.size();
+	evict();
+}
+
+void PatchCache::warm(const Glyphs& glyphs)
+{
+	static constexpr Symmetry symmetries[] = { Symmetry::AnySym, Symmetry::HoriSym, Symmetry::VertSym, Symmetry::HoriVertSym, Symmetry::Rot2Sym, Symmetry::Rot4Sym, Symmetry::FwdDiag, Symmetry::BackDiag, Symmetry::FullSym };
+	std::vector<std::vector<Transform>> groups;
+	for (const Symmetry sym : symmetries)
+		groups.push_back(symmetry_group(sym));
+
+	const GridSize size = glyphs.size();
+	const int max_rows = std::min(PATCH_WARM_MAX_SIZE, size.rows);
+	const int max_columns = std::min(PATCH_WARM_MAX_SIZE, size.columns);
+
+	/// Every size of window is stored at each position in turn, so that on a grid too large to visit every window, the windows stored are of every size.
+	int windows = 0;
+	for (const Point min : SelectionRange(Selection{ { 0, 0 }, { size.rows - 1, size.columns - 1 } }))
+	for (int rows = 1; rows <= std::min(max_rows, size.rows - min.i); ++rows)
+	for (int columns = 1; columns <= std::min(max_columns, size.columns - min.j); ++columns)
+	{
+		if (++windows > PATCH_WARM_MAX_WINDOWS)
+			return;
+		const Selection window = { min, min + Point{ rows - 1, columns - 1 } };
+
+		/// Leave out a window if a strand crosses the edge of the grid beside it, since the knot must have been wrapped, and the window keyed as if it were not.
+		const bool wrapped = std::ranges::any_of(SelectionRange(window), [&](Point p)
+			{
+				return std::ranges::any_of(sides, [&](const Side& side)
+					{
+						const Point q = p + Point::movement(side.outward);
+						return (q.i < 0 || q.i >= size.rows || q.j < 0 || q.j >= size.columns) && connection_of(index_of(glyphs[p]), Transform::identity, side.outward) != Connection::EMPTY;
+					});
+			});
+		if (wrapped)
+			continue;
+
+		/// The window has a symmetry if each of its transforms takes every glyph onto the glyph at the image of its cell, which is checked up to the first mismatch.
+		std::vector<Symmetry> found;
+		for (std::size_t s = 0; s < std::size(symmetries); ++s)
+		{
+			if (!window.is_square() && (symmetries[s] % Symmetry::Rot4Sym || symmetries[s] % Symmetry::FwdDiag || symmetries[s] % Symmetry::BackDiag))
+				continue;
+
+			const bool symmetric = std::ranges::all_of(groups[s], [&](Transform transform)
+				{
+					return std::ranges::all_of(SelectionRange(window), [&](Point p) { return glyphs[apply(transform, p, window)] == glyphs[p]->*GlyphsTransformed::member(transform); });
+				});
+			if (symmetric)
+				found.push_back(symmetries[s]);
+		}
+
+		/// Only storing the patches needs the lock, so that generating on another thread is only held up for a moment at a time.
+		const std::vector<std::uint8_t> patch = patch_of(glyphs, window);
+		std::scoped_lock lock(mutex);
+		for (const Symmetry sym : found)
+		{
+			Entry& entry = entry_for(make_key(glyphs, window, sym, {}, false, false, false));
+			add(entry, std::vector<std::uint8_t>(patch));
+		}
+		evict();
+	}
+}
+
+std::size_t PatchCache::bytes() const
+{
+	std::scoped_lock lock(mutex);
+	return _bytes;
+}
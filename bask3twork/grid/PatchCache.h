@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Forward.h"
+#include "pure/GlyphGrid.h"
+#include "pure/Selection.h"
+
+/** Knots generated before, kept for selections of the same size, symmetry and surroundings, so that rerolling a selection can reuse them straight away.
+ *
+ * A patch only has to meet the requirements in its key: the size of the selection, its symmetry and pattern, the \c Connection which each side of the selection meets,
+ * and the glyphs locked inside it. Any patch stored under a key therefore fits every selection with the same key, wherever it is in the grid.
+ *
+ * Each key keeps up to \c PATCH_CACHE_VARIANTS patches, which are handed out in turn. Once every one of them has been handed out, PatchCache::take() finds nothing,
+ * so that Knot::generator() generates a new patch and stores it, until the key has all of its variants, and only then goes round them again.
+ * A key also goes round them again once a new patch turns out to be one it already has, since a small selection may have fewer knots than that.
+ * The keys used least recently are dropped whenever the cache takes up more than \c PATCH_CACHE_BYTES.
+ *
+ * Every member function locks the cache, since it is shared by the Knot and the copies of it made by Knot::generator() for the generating thread.
+ */
+class PatchCache
+{
+public:
+	/// The requirements of a selection, packed into bytes, see PatchCache::key_of()
+	using Key = std::string;
+
+	static Key key_of(const Glyphs& base, Selection selection, Symmetry sym, const Pattern& pattern, bool wrap_x, bool wrap_y);
+
+	std::optional<Glyphs> take(const Key& key, const Glyphs& base, Selection selection, const Glyphs& current);
+	void store(const Key& key, const Glyphs& glyphs, Selection selection);
+	void warm(const Glyphs& glyphs);
+
+	std::size_t bytes() const;
+
+private:
+	/// The patches of one key, each holding the encoded glyphs of the selection in raster order, see GlyphGrid::encode()
+	struct Entry
+	{
+		Key key;
+		std::vector<std::vector<std::uint8_t>> patches;
+		std::size_t next = 0; ///< The patch to hand out next, which is \c patches.size() once they have all been handed out
+		bool cycling = false; ///< Whether to go round the patches again once they have all been handed out, rather than have new ones generated
+	};
+
+	mutable std::mutex mutex;
+	std::list<Entry> entries; ///< Every key, with the one used most recently first
+	std::unordered_map<Key, std::list<Entry>::iterator> index;
+	std::size_t _bytes = 0;
+
+	Entry& entry_for(const Key& key);
+	bool add(Entry& entry, std::vector<std::uint8_t>&& patch);
+	void evict();
+
+	static Key make_key(const Glyphs& glyphs, Selection selection, Symmetry sym, const Pattern& pattern, bool wrap_x, bool wrap_y, bool locked_inside);
+	static std::vector<std::uint8_t> patch_of(const Glyphs& glyphs, Selection selection);
+};
+
+/* PatchCache */
+/** \fn PatchCache::key_of(const Glyphs& base, Selection selection, Symmetry sym, const Pattern& pattern, bool wrap_x, bool wrap_y)
+ * The key of a selection about to be generated, from the glyphs made by Knot::make_base_glyphs().
+ * Each side of the selection is keyed by the \c Connection of the glyph across it, which is \c Connection::EMPTY across an edge of the grid without wrapping,
+ * or by a marker if the cell across it is part of the selection itself, or still to be generated.
+ */
+/** \fn PatchCache::take(const Key& key, const Glyphs& base, Selection selection, const Glyphs& current)
+ * Hand out the next patch stored under \c key, skipping it if it is the same as the selection of \c current, so that a reroll always changes the knot.
+ *
+ * \return A copy of \c base with the patch written into \c selection, or \c std::nullopt if there is no patch left to hand out
+ */
+/** \fn PatchCache::store(const Key& key, const Glyphs& glyphs, Selection selection)
+ * Add the selection of \c glyphs under \c key, replacing the oldest patch if the key already has \c PATCH_CACHE_VARIANTS of them.
+ * If it is already there, the key goes round its patches again from then on, rather than having new ones generated.
+ */
+/** \fn PatchCache::warm(const Glyphs& glyphs)
+ * Store every window of up to \c PATCH_WARM_MAX_SIZE by \c PATCH_WARM_MAX_SIZE cells of a knot, such as one read from a \c .k3knot file,
+ * keyed as if it were a selection with no locked glyphs and no wrapping. Each window is stored with no symmetry, and again with every symmetry which it has.
+ * A window on the edge of the grid is left out if a strand crosses that edge, since the knot must have been wrapped.
+ * At most \c PATCH_WARM_MAX_WINDOWS windows are looked at, starting from the upper left, so that opening a large knot stays quick.
+ */
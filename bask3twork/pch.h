@@ -19,16 +19,32 @@
 #include <wx/statusbr.h>
 #include <wx/string.h>
 #include <wx/textctrl.h>
+#include <wx/textdlg.h>
 #include <wx/textfile.h>
+#include <wx/utils.h>
 #include <wx/window.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
+#include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <execution>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <random>
+#include <set>
+#include <span>
+#include <thread>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "Forward.h"
@@ -15,6 +15,8 @@ enum class Connection : uint8_t
 	ORTHO_RIGHT, ///< Only the strand from \c ORTHO_BOTH that is running vertical, on the right half
 };
 
+constexpr std::size_t ConnectionCount = static_cast<std::size_t>(Connection::ORTHO_RIGHT) + 1; ///< The number of \c Connection values, including \c DO_NOT_CARE
+
 struct ConnectionTransformations
 {
 	using enum Connection;
@@ -40,6 +42,26 @@ constexpr Connection mirror_backward_diagonal(Connection input) { return Connect
 
 using ConnectionFn = Connection(*)(Connection);
 
+/// The number of strands which pass through an edge with this connection
+constexpr int strand_count(Connection input)
+{
+	switch (input)
+	{
+	case Connection::DIAG_BOTH:
+	case Connection::ORTHO_BOTH:
+		return 2;
+	case Connection::DIAG_FRONT:
+	case Connection::DIAG_BACK:
+	case Connection::ORTHO_UP:
+	case Connection::ORTHO_DOWN:
+	case Connection::ORTHO_LEFT:
+	case Connection::ORTHO_RIGHT:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
 struct Connections
 {
 	Connection up;
@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "pure/ConnectionMask.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CONNECTION_MASK_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_FUNCTION
+#else
+#define AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+	using Words = std::array<GlyphSet::word_type, GlyphSet::word_count>;
+	using Kernel = Words (*)(const Connection* bytes, Connection connection);
+
+	Words match_scalar(const Connection* bytes, Connection connection)
+	{
+		Words words = {};
+		for (std::size_t index = 0; index < GlyphSet::capacity; ++index)
+			if (bytes[index] == connection)
+				words[index / GlyphSet::word_bits] |= GlyphSet::word_type{ 1 } << (index % GlyphSet::word_bits);
+		return words;
+	}
+
+#ifdef CONNECTION_MASK_X86
+	static_assert(GlyphSet::word_bits % 32 == 0);
+
+	/// Four compares of 16 bytes make each word, whose bit masks are shifted into place
+	Words match_sse2(const Connection* bytes, Connection connection)
+	{
+		const __m128i wanted = _mm_set1_epi8(static_cast<char>(connection));
+		Words words = {};
+		for (std::size_t index = 0; index < GlyphSet::capacity; index += 16)
+		{
+			const __m128i loaded = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + index));
+			const auto mask = static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(loaded, wanted)));
+			words[index / GlyphSet::word_bits] |= GlyphSet::word_type{ mask } << (index % GlyphSet::word_bits);
+		}
+		return words;
+	}
+
+	/// Two compares of 32 bytes make each word
+	AVX2_FUNCTION Words match_avx2(const Connection* bytes, Connection connection)
+	{
+		const __m256i wanted = _mm256_set1_epi8(static_cast<char>(connection));
+		Words words = {};
+		for (std::size_t index = 0; index < GlyphSet::capacity; index += 32)
+		{
+			const __m256i loaded = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + index));
+			const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(loaded, wanted)));
+			words[index / GlyphSet::word_bits] |= GlyphSet::word_type{ mask } << (index % GlyphSet::word_bits);
+		}
+		return words;
+	}
+
+	/// Whether the processor has AVX2, and the operating system saves the wider registers, which it must for them to be used
+	bool has_avx2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+		__cpuid(info, 1);
+		const bool os_saves_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+		if (!os_saves_avx)
+			return false;
+		__cpuidex(info, 7, 0);
+		return info[1] & (1 << 5);
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	/// Every kernel that can run here, the fastest last, ending with the scalar one if there are no others
+	std::span<const Kernel> kernels()
+	{
+		static const auto available = []
+		{
+			std::vector<Kernel> found = { match_scalar };
+#ifdef CONNECTION_MASK_X86
+			found.push_back(match_sse2); // Every x86 processor this runs on has SSE2
+			if (has_avx2())
+				found.push_back(match_avx2);
+#endif
+			return found;
+		}();
+		return available;
+	}
+}
+
+GlyphSet glyphs_matching(const ConnectionBytes& connections, Connection connection)
+{
+	const std::span<const Kernel> available = kernels();
+	const Words words = available.back()(connections.data(), connection);
+#ifdef _DEBUG
+	for (const Kernel kernel : available)
+		wxASSERT_MSG(kernel(connections.data(), connection) == words, "The kernels for matching connections disagree");
+#endif
+	return GlyphSet::from_words(words);
+}
+
+GlyphSet glyphs_matching_scalar(const ConnectionBytes& connections, Connection connection)
+{
+	return GlyphSet::from_words(match_scalar(connections.data(), connection));
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <array>
+#include "pure/Connection.h"
+#include "pure/GlyphSet.h"
+/// \file
+
+/// The connection on one side of every glyph, one byte for each index into \c AllGlyphs, with room for as many glyphs as a \c GlyphSet holds
+using ConnectionBytes = std::array<Connection, GlyphSet::capacity>;
+
+/** The set of indices whose byte in \c connections is \c connection.
+ *
+ * The bytes are compared 32 at a time with AVX2 where the processor supports it, otherwise 16 at a time with SSE2 on x86,
+ * and otherwise one at a time, which is chosen once, on the first call. Every byte is compared, including those past the last glyph,
+ * so the caller should keep only the indices which are glyphs. In debug builds, each result is checked against every other kernel that can run.
+ */
+GlyphSet glyphs_matching(const ConnectionBytes& connections, Connection connection);
+
+/// The same as glyphs_matching(), comparing one byte at a time, which the vector kernels must agree with
+GlyphSet glyphs_matching_scalar(const ConnectionBytes& connections, Connection connection);
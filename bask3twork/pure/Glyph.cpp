@@ -1,35 +1,93 @@
 #include "pch.h"
+#include "pure/ConnectionMask.h"
 #include "pure/Glyph.h"
+#include "pure/GlyphWeights.h"
+#include "pure/Random.h"
 
-static bool compatible(Connections known, Connections checking)
+namespace
 {
-	return (known.up    == Connection::DO_NOT_CARE || known.up    == checking.up)
-	    && (known.down  == Connection::DO_NOT_CARE || known.down  == checking.down)
-	    && (known.left  == Connection::DO_NOT_CARE || known.left  == checking.left)
-	    && (known.right == Connection::DO_NOT_CARE || known.right == checking.right);
+	/// For each side, the set of glyphs having each \c Connection on that side, and for each \c GlyphFlag bit, the set of glyphs having that bit.
+	/// Built once on first use, so that Glyph::Candidates() is a handful of intersections rather than a scan over \c AllGlyphs.
+	class CandidateIndex
+	{
+	public:
+		CandidateIndex()
+		{
+			// The connections are laid out as one array of bytes for each side, so that glyphs_matching() finds each set many glyphs at a time.
+			// The bytes past the last glyph are left as DO_NOT_CARE, whose sets are given every glyph below.
+			ConnectionBytes up_bytes = {}, down_bytes = {}, left_bytes = {}, right_bytes = {};
+			for (std::size_t index = 0; index < AllGlyphs.size(); ++index)
+			{
+				const Glyph& glyph = AllGlyphs[index];
+				up_bytes[index] = glyph.up;
+				down_bytes[index] = glyph.down;
+				left_bytes[index] = glyph.left;
+				right_bytes[index] = glyph.right;
+
+				for (std::size_t bit = 0; bit < flags.size(); ++bit)
+					if (to_underlying(glyph.flags) & (1 << bit))
+						flags[bit].insert(index);
+			}
+			for (std::size_t c = 0; c < ConnectionCount; ++c)
+			{
+				const Connection connection = static_cast<Connection>(c);
+				up[c] = glyphs_matching(up_bytes, connection);
+				down[c] = glyphs_matching(down_bytes, connection);
+				left[c] = glyphs_matching(left_bytes, connection);
+				right[c] = glyphs_matching(right_bytes, connection);
+			}
+
+			const GlyphSet all = GlyphSet::first(AllGlyphs.size());
+			up[to_index(Connection::DO_NOT_CARE)] = all;
+			down[to_index(Connection::DO_NOT_CARE)] = all;
+			left[to_index(Connection::DO_NOT_CARE)] = all;
+			right[to_index(Connection::DO_NOT_CARE)] = all;
+		}
+
+		GlyphSet get(Connections connections, GlyphFlag required) const
+		{
+			GlyphSet set = up[to_index(connections.up)] & down[to_index(connections.down)] & left[to_index(connections.left)] & right[to_index(connections.right)];
+			for (auto bits = static_cast<unsigned>(to_underlying(required)); bits != 0; bits &= bits - 1)
+				set &= flags[std::countr_zero(bits)];
+			return set;
+		}
+
+	private:
+		static std::size_t to_index(Connection connection) { return static_cast<std::size_t>(connection); }
+
+		std::array<GlyphSet, ConnectionCount> up;
+		std::array<GlyphSet, ConnectionCount> down;
+		std::array<GlyphSet, ConnectionCount> left;
+		std::array<GlyphSet, ConnectionCount> right;
+		std::array<GlyphSet, 32> flags;
+	};
 }
 
-const Glyph* Glyph::Random(Connections connections, GlyphFlag flags)
-/// This function takes in the desired flags and outputs the vector of all glyphs which meet the criteria.
-/// 
+GlyphSet Glyph::Candidates(Connections connections, GlyphFlag flags)
+/// This function takes in the desired connections and flags, and outputs the set of all glyphs which meet the criteria.
+///
 /// \param connections The \c Connections required. If any connection should be disregarded, then pass \c Connection::DO_NOT_CARE.
 /// \param flags The bit flags required for this \c Glyph. Any bits with a value of \c 0 are ignored, and any bits with a value of \c 1 are required.
-/// \return A pointer to a randomly selected \c Glyph that fits the criteria, or \c nullptr if nothing exists.
+/// \return The set of indices into \c AllGlyphs of every \c Glyph that fits the criteria.
 {
-	static std::vector<const Glyph*> glyph_list(AllGlyphs.size(), nullptr);
-	glyph_list.clear();
-
-	for (auto& glyph : AllGlyphs)
-		if (compatible(connections, glyph) && (glyph.flags % flags))
-			glyph_list.push_back(&glyph);
+	static const CandidateIndex index;
+	return index.get(connections, flags);
+}
 
-	if (glyph_list.empty())
+const Glyph* Glyph::Random(Connections connections, GlyphFlag flags, Rng& rng, const GlyphWeights* weights)
+/// This function takes in the desired connections and flags, and outputs a randomly chosen glyph from Glyph::Candidates().
+///
+/// \param connections The \c Connections required. If any connection should be disregarded, then pass \c Connection::DO_NOT_CARE.
+/// \param flags The bit flags required for this \c Glyph. Any bits with a value of \c 0 are ignored, and any bits with a value of \c 1 are required.
+/// \param rng The random engine to choose with, which should belong to the calling thread.
+/// \param weights How likely each candidate is to be chosen, see GlyphWeights::choose(), or \c nullptr to choose uniformly.
+/// \return A pointer to a randomly selected \c Glyph that fits the criteria, or \c nullptr if nothing exists.
+{
+	const GlyphSet candidates = Candidates(connections, flags);
+	if (candidates.empty())
 		return nullptr;
-	else
-	{
-		static std::mt19937 twister{ std::random_device{}() };
-		static const Glyph* glyph = nullptr;
-		std::ranges::sample(glyph_list, &glyph, 1, twister);
-		return glyph;
-	}
+
+	if (weights)
+		return &AllGlyphs[weights->choose(candidates, rng)];
+	return &AllGlyphs[candidates.nth(rng.below(candidates.count()))];
 }
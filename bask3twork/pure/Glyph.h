@@ -1,6 +1,8 @@
 #pragma once
 #include "Forward.h"
 #include "pure/Connection.h"
+#include "pure/GlyphSet.h"
+#include "pure/Transform.h"
 #include "pure/UsableEnum.h"
 #include <map>
 #include <vector>
@@ -60,6 +62,22 @@ struct GlyphsTransformed
 		if (transform == &GlyphsTransformed::mirror_backward_diagonal) return &GlyphsTransformed::mirror_backward_diagonal;
 		throw;
 	}
+
+	static constexpr const Glyph* GlyphsTransformed::* member(Transform transform)
+	{
+		switch (transform)
+		{
+		case Transform::identity:                 return &GlyphsTransformed::identity;
+		case Transform::rotate_90:                return &GlyphsTransformed::rotate_90;
+		case Transform::rotate_180:               return &GlyphsTransformed::rotate_180;
+		case Transform::rotate_270:               return &GlyphsTransformed::rotate_270;
+		case Transform::mirror_x:                 return &GlyphsTransformed::mirror_x;
+		case Transform::mirror_y:                 return &GlyphsTransformed::mirror_y;
+		case Transform::mirror_forward_diagonal:  return &GlyphsTransformed::mirror_forward_diagonal;
+		case Transform::mirror_backward_diagonal: return &GlyphsTransformed::mirror_backward_diagonal;
+		}
+		throw;
+	}
 };
 
 /// A struct to store the glyph information of the the Celtic Knots font
@@ -82,7 +100,8 @@ struct Glyph : GlyphsTransformed, Connections
 	Glyph& operator=(const Glyph&) = delete;
 	Glyph& operator=(Glyph&&) = delete;
 
-	static const Glyph* Random(Connections connections, GlyphFlag flags);
+	static GlyphSet Candidates(Connections connections, GlyphFlag flags);
+	static const Glyph* Random(Connections connections, GlyphFlag flags, Rng& rng, const GlyphWeights* weights = nullptr);
 };
 
 consteval GlyphFlag Glyph::get_flags() const
@@ -116,6 +135,13 @@ consteval GlyphFlag Glyph::get_flags() const
 /// The constexpr array of every \c Glyph in the program, the only place where a Glyph object is initialized;
 /// every other place a \c Glyph is referenced in the whole codebase is actually a pointer to a \c Glyph in \c AllGlyphs.
 #include "generated/AllGlyphs.impl"
+static_assert(AllGlyphs.size() <= GlyphSet::capacity);
+
+/// The index of a \c Glyph within \c AllGlyphs, which is its element in a \c GlyphSet
+constexpr std::size_t index_of(const Glyph* glyph) { return static_cast<std::size_t>(glyph - AllGlyphs.data()); }
+
+/// The \c Glyph at \c index within \c AllGlyphs, under the given transformation
+constexpr const Glyph* transformed(std::size_t index, Transform transform) { return AllGlyphs[index].*GlyphsTransformed::member(transform); }
 
 /// The mapping from the unicode character to the Glyph that uses that character, used for reading knots.
 #include "generated/UnicharToGlyph.impl"
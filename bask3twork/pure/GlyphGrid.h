@@ -0,0 +1,66 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "pure/Glyph.h"
+#include "pure/GridSize.h"
+#include "pure/Selection.h"
+/// \file
+
+/** A grid of glyphs, stored in row-major order in a single allocation, as the index of each \c Glyph within \c AllGlyphs.
+ *
+ * A cell can also hold no glyph, which reads as \c nullptr, such as the cells of a selection which are still to be generated.
+ */
+class GlyphGrid
+{
+public:
+	static constexpr std::uint8_t no_glyph = 0xFF; ///< The index stored in a cell which holds no glyph
+
+	GlyphGrid() = default;
+	explicit GlyphGrid(GridSize size, const Glyph* glyph = SpaceGlyph) : _size(size), indices(static_cast<std::size_t>(size.area()), encode(glyph)) {}
+
+	GridSize size() const { return _size; }
+
+	const Glyph* operator[](Point point) const { return decode(indices[offset(point)]); }
+	void set(Point point, const Glyph* glyph) { indices[offset(point)] = encode(glyph); }
+
+	void copy_selection(const GlyphGrid& from, Selection selection);
+
+	std::span<std::uint8_t> row(int i) { return { indices.data() + offset({ i, 0 }), static_cast<std::size_t>(_size.columns) }; }
+	std::span<const std::uint8_t> row(int i) const { return { indices.data() + offset({ i, 0 }), static_cast<std::size_t>(_size.columns) }; }
+
+	static std::uint8_t encode(const Glyph* glyph) { return glyph ? static_cast<std::uint8_t>(index_of(glyph)) : no_glyph; }
+	static const Glyph* decode(std::uint8_t index) { return index == no_glyph ? nullptr : &AllGlyphs[index]; }
+
+	friend bool operator==(const GlyphGrid&, const GlyphGrid&) = default;
+
+private:
+	GridSize _size = { 0, 0 };
+	std::vector<std::uint8_t> indices;
+
+	std::size_t offset(Point point) const { return static_cast<std::size_t>(point.i) * _size.columns + point.j; }
+};
+
+static_assert(AllGlyphs.size() <= GlyphGrid::no_glyph);
+
+inline void GlyphGrid::copy_selection(const GlyphGrid& from, Selection selection)
+{
+	for (int i = selection.min.i; i <= selection.max.i; ++i)
+	{
+		const std::span<const std::uint8_t> source = from.row(i).subspan(selection.min.j, selection.columns());
+		std::ranges::copy(source, row(i).begin() + selection.min.j);
+	}
+}
+
+/* GlyphGrid */
+/** \fn GlyphGrid::GlyphGrid(GridSize size, const Glyph* glyph)
+ * Constructor for a grid of the given size, with \c glyph in every cell.
+ */
+/** \fn GlyphGrid::copy_selection(const GlyphGrid& from, Selection selection)
+ * Copy the cells of \c selection from \c from, which must be the same size, leaving every other cell as it is.
+ * This makes no allocations, so it can reset a grid which is reused many times.
+ */
+/** \fn GlyphGrid::row(int i)
+ * The indices of the glyphs in row \c i, to be read with GlyphGrid::decode() and written with GlyphGrid::encode().
+ */
@@ -0,0 +1,125 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+/// \file
+
+/// A set of glyphs, stored as one bit per index into \c AllGlyphs, so that intersecting candidate sets is a handful of word operations
+class GlyphSet
+{
+public:
+	using word_type = std::uint64_t;
+	static constexpr std::size_t word_bits = 64;
+	static constexpr std::size_t word_count = 3;
+	static constexpr std::size_t capacity = word_bits * word_count; ///< The largest number of glyphs that can be indexed
+
+	constexpr GlyphSet() = default;
+
+	/// The set of the first \c count indices, i.e. every glyph when passed \c AllGlyphs.size()
+	static constexpr GlyphSet first(std::size_t count)
+	{
+		GlyphSet set;
+		for (std::size_t index = 0; index < count; ++index)
+			set.insert(index);
+		return set;
+	}
+
+	/// The set holding index \c w * \c word_bits + \c b for each bit \c b set in \c words[w]
+	static constexpr GlyphSet from_words(const std::array<word_type, word_count>& words)
+	{
+		GlyphSet set;
+		set.words = words;
+		return set;
+	}
+
+	constexpr void insert(std::size_t index) { words[index / word_bits] |= word_type{ 1 } << (index % word_bits); }
+	constexpr void erase(std::size_t index) { words[index / word_bits] &= ~(word_type{ 1 } << (index % word_bits)); }
+	constexpr bool contains(std::size_t index) const { return (words[index / word_bits] >> (index % word_bits)) & 1; }
+
+	constexpr bool empty() const
+	{
+		return (words[0] | words[1] | words[2]) == 0;
+	}
+
+	constexpr std::size_t count() const
+	{
+		return std::popcount(words[0]) + std::popcount(words[1]) + std::popcount(words[2]);
+	}
+
+	/// The index of the \c n th element in ascending order, which must be less than \c count()
+	constexpr std::size_t nth(std::size_t n) const
+	{
+		for (std::size_t w = 0; w < word_count; ++w)
+		{
+			word_type word = words[w];
+			const std::size_t in_word = std::popcount(word);
+			if (n >= in_word)
+			{
+				n -= in_word;
+				continue;
+			}
+			for (; n != 0; --n)
+				word &= word - 1; // Clear the lowest set bit
+			return w * word_bits + std::countr_zero(word);
+		}
+		return capacity;
+	}
+
+	/// Calls \c fn with the index of each element in ascending order
+	template <class Fn>
+	constexpr void for_each(Fn&& fn) const
+	{
+		for (std::size_t w = 0; w < word_count; ++w)
+			for (word_type word = words[w]; word != 0; word &= word - 1)
+				fn(w * word_bits + std::countr_zero(word));
+	}
+
+	constexpr GlyphSet& operator&=(const GlyphSet& that)
+	{
+		for (std::size_t w = 0; w < word_count; ++w)
+			words[w] &= that.words[w];
+		return *this;
+	}
+
+	constexpr GlyphSet& operator|=(const GlyphSet& that)
+	{
+		for (std::size_t w = 0; w < word_count; ++w)
+			words[w] |= that.words[w];
+		return *this;
+	}
+
+	/// Keeps the elements in exactly one of the two sets
+	constexpr GlyphSet& operator^=(const GlyphSet& that)
+	{
+		for (std::size_t w = 0; w < word_count; ++w)
+			words[w] ^= that.words[w];
+		return *this;
+	}
+
+	/// Removes every element of \c that
+	constexpr GlyphSet& operator-=(const GlyphSet& that)
+	{
+		for (std::size_t w = 0; w < word_count; ++w)
+			words[w] &= ~that.words[w];
+		return *this;
+	}
+
+	friend constexpr GlyphSet operator&(GlyphSet lhs, const GlyphSet& rhs) { return lhs &= rhs; }
+	friend constexpr GlyphSet operator|(GlyphSet lhs, const GlyphSet& rhs) { return lhs |= rhs; }
+	friend constexpr GlyphSet operator^(GlyphSet lhs, const GlyphSet& rhs) { return lhs ^= rhs; }
+	friend constexpr GlyphSet operator-(GlyphSet lhs, const GlyphSet& rhs) { return lhs -= rhs; }
+
+	friend constexpr bool operator==(const GlyphSet&, const GlyphSet&) = default;
+
+	/// A hash of the elements, for keying tables by a set of candidates
+	constexpr std::size_t hash() const
+	{
+		std::uint64_t mixed = 0;
+		for (const word_type word : words)
+			mixed = (mixed ^ word) * 0x9E3779B97F4A7C15;
+		return static_cast<std::size_t>(mixed ^ (mixed >> 32));
+	}
+
+private:
+	std::array<word_type, word_count> words = {};
+};
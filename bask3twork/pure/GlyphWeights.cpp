@@ -0,0 +1,127 @@
+#include "pch.h"
+#include "pure/GlyphWeights.h"
+#include "pure/Glyph.h"
+#include "pure/Random.h"
+
+namespace
+{
+	/// The alias table of one set of candidates, where each column holds one candidate, and gives way to its alias with the chance left over.
+	/// It has room for every glyph, so that building one over another makes no allocations.
+	struct AliasTable
+	{
+		std::size_t count = 0;                                 ///< The number of columns, one for each candidate
+		std::array<std::uint8_t, GlyphSet::capacity> glyphs;  ///< The candidate of each column
+		std::array<double, GlyphSet::capacity> keep;          ///< The chance of choosing the candidate of each column, rather than its alias
+		std::array<std::uint8_t, GlyphSet::capacity> aliases; ///< The column whose candidate is chosen otherwise
+
+		/// Builds the table by Vose's method, in time linear in the number of candidates
+		void build(const GlyphSet& candidates, const std::array<double, GlyphSet::capacity>& weights)
+		{
+			count = 0;
+			candidates.for_each([&](std::size_t glyph) { glyphs[count++] = static_cast<std::uint8_t>(glyph); });
+
+			double total = 0;
+			for (std::size_t column = 0; column < count; ++column)
+				total += weights[glyphs[column]];
+
+			/// Scale each weight so that they average \c 1, then pair each column below \c 1 with one above it, which fills up the rest of the smaller column.
+			std::array<std::uint8_t, GlyphSet::capacity> small;
+			std::array<std::uint8_t, GlyphSet::capacity> large;
+			std::size_t small_count = 0;
+			std::size_t large_count = 0;
+			for (std::size_t column = 0; column < count; ++column)
+			{
+				keep[column] = total > 0 ? weights[glyphs[column]] * static_cast<double>(count) / total : 1;
+				aliases[column] = static_cast<std::uint8_t>(column);
+				if (keep[column] < 1)
+					small[small_count++] = static_cast<std::uint8_t>(column);
+				else
+					large[large_count++] = static_cast<std::uint8_t>(column);
+			}
+			while (small_count != 0 && large_count != 0)
+			{
+				const std::uint8_t less = small[--small_count];
+				const std::uint8_t more = large[large_count - 1];
+				aliases[less] = more;
+				keep[more] -= 1 - keep[less];
+				if (keep[more] < 1)
+				{
+					--large_count;
+					small[small_count++] = more;
+				}
+			}
+
+			/// Whatever is left over is only short of \c 1 by rounding, so always keeps its own candidate.
+			for (std::size_t index = 0; index < small_count; ++index)
+				keep[small[index]] = 1;
+			for (std::size_t index = 0; index < large_count; ++index)
+				keep[large[index]] = 1;
+		}
+
+		std::size_t choose(Rng& rng) const
+		{
+			const std::size_t column = rng.below(count);
+			return rng.unit() < keep[column] ? glyphs[column] : glyphs[aliases[column]];
+		}
+	};
+
+	/// Keys the alias table built for a set of candidates from the weights with a given id
+	struct AliasKey
+	{
+		std::uint64_t id;
+		GlyphSet candidates;
+
+		friend bool operator==(const AliasKey&, const AliasKey&) = default;
+	};
+
+	struct AliasKeyHash
+	{
+		std::size_t operator()(const AliasKey& key) const { return key.candidates.hash() ^ std::hash<std::uint64_t>{}(key.id); }
+	};
+
+	/// One slot of the alias tables kept by a thread, holding the table of whichever set of candidates last hashed to it
+	struct AliasSlot
+	{
+		bool filled = false;
+		AliasKey key;
+		AliasTable table;
+	};
+
+	std::uint64_t next_id()
+	{
+		static std::atomic<std::uint64_t> ids = 0;
+		return ids++;
+	}
+}
+
+GlyphWeights::GlyphWeights()
+	: id(next_id())
+{
+	weights.fill(1);
+}
+
+void GlyphWeights::set(std::size_t glyph, double weight)
+{
+	weights[glyph] = weight;
+	_uniform = std::all_of(weights.begin(), weights.begin() + AllGlyphs.size(), [&](double other) { return other == weights[0]; });
+	id = next_id();
+}
+
+std::size_t GlyphWeights::choose(const GlyphSet& candidates, Rng& rng) const
+{
+	if (_uniform)
+		return candidates.nth(rng.below(candidates.count()));
+
+	/// Each thread keeps its own tables, so that choosing never waits on a lock. They are kept in a fixed number of slots, allocated once for each thread,
+	/// and a set of candidates whose slot holds another set builds its table over that one, so that choosing makes no allocations from then on.
+	thread_local const std::unique_ptr<std::array<AliasSlot, ALIAS_CACHE_ENTRIES>> slots = std::make_unique<std::array<AliasSlot, ALIAS_CACHE_ENTRIES>>();
+	const AliasKey key{ id, candidates };
+	AliasSlot& slot = (*slots)[AliasKeyHash{}(key) % ALIAS_CACHE_ENTRIES];
+	if (!slot.filled || slot.key != key)
+	{
+		slot.table.build(candidates, weights);
+		slot.key = key;
+		slot.filled = true;
+	}
+	return slot.table.choose(rng);
+}
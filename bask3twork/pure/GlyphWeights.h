@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "Forward.h"
+#include "pure/GlyphSet.h"
+/// \file
+
+/** How likely each glyph is to be chosen when generating, so that a style can favour some glyphs over others, such as fewer empty tiles or more crossings.
+ *
+ * Each glyph has a weight of at least \c 0, which is \c 1 for every glyph until changed, and a glyph is chosen from a set of candidates in proportion to its weight.
+ * A weight applies to the glyph chosen for an orbit's first cell, and its images follow from it under the symmetry, whatever their own weights.
+ *
+ * Choosing is constant time, by Vose's alias method. The alias table of each set of candidates is built the first time that set is chosen from,
+ * and kept for the thread which built it, in one of \c ALIAS_CACHE_ENTRIES slots, since the same few sets come up again and again while generating.
+ * The slots are allocated the first time a thread chooses by weight, and tables are built over each other in place, so choosing makes no allocations after that.
+ */
+class GlyphWeights
+{
+public:
+	GlyphWeights();
+
+	double get(std::size_t glyph) const { return weights[glyph]; }
+	void set(std::size_t glyph, double weight);
+
+	/// Whether every glyph has the same weight, so that choosing is uniform
+	bool uniform() const { return _uniform; }
+
+	std::size_t choose(const GlyphSet& candidates, Rng& rng) const;
+
+private:
+	std::array<double, GlyphSet::capacity> weights;
+	bool _uniform = true;
+	std::uint64_t id; ///< Unique to these weights, changing whenever one is set, which keys the alias tables built from them
+};
+
+/* GlyphWeights */
+/** \fn GlyphWeights::GlyphWeights()
+ * Every glyph with a weight of \c 1.
+ */
+/** \fn GlyphWeights::set(std::size_t glyph, double weight)
+ * Set the weight of the glyph with index \c glyph within \c AllGlyphs, which must be finite and at least \c 0.
+ * A glyph with a weight of \c 0 is only chosen when every candidate has a weight of \c 0.
+ */
+/** \fn GlyphWeights::choose(const GlyphSet& candidates, Rng& rng) const
+ * Choose one of \c candidates, which must not be empty, in proportion to their weights, or uniformly if they all have a weight of \c 0.
+ * If every glyph has the same weight, this draws from \c rng exactly as \c candidates.nth(rng.below(candidates.count())) does, so that a seed gives the same knot as without weights.
+ *
+ * \return The index of the chosen glyph within \c AllGlyphs
+ */
@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "pure/LockBitmap.h"
+#include "grid/Tile.h" // This breaks the dependency direction between folders, as in Symmetry.cpp
+
+LockBitmap::LockBitmap(const Tiles& tiles, Selection selection)
+	: selection(selection)
+	, rows(selection.rows())
+	, columns(selection.columns())
+	, words_per_line((std::max(rows, columns) + word_bits - 1) / word_bits)
+{
+	const std::size_t words = static_cast<std::size_t>(words_per_line) * std::max(rows, columns);
+	by_row.resize(words);
+	by_row_reversed.resize(words);
+	if (selection.is_square())
+	{
+		by_column.resize(words);
+		by_column_reversed.resize(words);
+	}
+
+	const auto set = [&](std::vector<word_type>& bits, int line, int index) { bits[static_cast<std::size_t>(line) * words_per_line + index / word_bits] |= word_type{ 1 } << (index % word_bits); };
+	for (int i = 0; i < rows; ++i)
+	{
+		const std::span<const Tile> row = selection.within(tiles[selection.min.i + i]);
+		for (int j = 0; j < columns; ++j)
+		{
+			if (!row[j].locked())
+				continue;
+			set(by_row, i, j);
+			set(by_row_reversed, i, columns - 1 - j);
+			if (!by_column.empty())
+			{
+				set(by_column, j, i);
+				set(by_column_reversed, j, rows - 1 - i);
+			}
+		}
+	}
+}
+
+std::span<const LockBitmap::word_type> LockBitmap::partner_of(Transform map, int row) const
+/** The bits of the tiles which \c map takes the tiles of \c row onto, in the same order, so that bit \c j is the tile which the tile in column \c j is taken to.
+ *
+ * For example, \c mirror_y takes column \c j to column \c columns-1-j of the same row, which is bit \c j of that row reversed,
+ * and \c mirror_backward_diagonal takes it to row \c j of column \c row, which is bit \c j of that column.
+ */
+{
+	const int last = rows - 1;
+	switch (map)
+	{
+	case Transform::identity:                 return line(by_row, row);
+	case Transform::mirror_x:                 return line(by_row, last - row);
+	case Transform::mirror_y:                 return line(by_row_reversed, row);
+	case Transform::rotate_180:               return line(by_row_reversed, last - row);
+	case Transform::rotate_90:                return line(by_column, last - row);
+	case Transform::rotate_270:               return line(by_column_reversed, row);
+	case Transform::mirror_forward_diagonal:  return line(by_column_reversed, last - row);
+	case Transform::mirror_backward_diagonal: return line(by_column, row);
+	}
+	throw;
+}
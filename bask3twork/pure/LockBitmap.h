@@ -0,0 +1,66 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Forward.h"
+#include "pure/Selection.h"
+#include "pure/Transform.h"
+/// \file
+
+/** Which tiles of a selection are locked, one bit per tile, packed 64 to a word along each row, so that finding the pairs of locked tiles which a symmetry maps onto each other
+ * takes one \c AND of two words for every 64 tiles, rather than looking at each tile in turn.
+ *
+ * The tile which a \c Transform maps each tile of a row onto lies along a row or a column of the selection, in one direction or the other,
+ * so along with the rows, the bitmap keeps them reversed, and for a square selection the columns too, both ways round. Each of those is filled in as the tiles are read,
+ * so every \c Transform pairs a row with a single row of one of the four, bit for bit.
+ */
+class LockBitmap
+{
+public:
+	using word_type = std::uint64_t;
+	static constexpr int word_bits = 64;
+
+	LockBitmap(const Tiles& tiles, Selection selection);
+
+	template <typename Visit>
+	bool for_each_locked_pair(Transform map, Visit visit) const;
+
+private:
+	Selection selection;
+	int rows;
+	int columns;
+	int words_per_line; ///< The words taken by each row, and each column of a square selection
+
+	std::vector<word_type> by_row;              ///< Bit \c j of row \c i is set if the tile at row \c i and column \c j of the selection is locked
+	std::vector<word_type> by_row_reversed;     ///< Bit \c j of row \c i is bit \c columns-1-j of the row in \c by_row
+	std::vector<word_type> by_column;           ///< Bit \c i of column \c j is bit \c j of row \c i in \c by_row, only for a square selection
+	std::vector<word_type> by_column_reversed;  ///< Bit \c i of column \c j is bit \c rows-1-i of the column in \c by_column, only for a square selection
+
+	std::span<const word_type> line(const std::vector<word_type>& bits, int index) const { return std::span(bits).subspan(static_cast<std::size_t>(index) * words_per_line, words_per_line); }
+	std::span<const word_type> partner_of(Transform map, int row) const;
+};
+
+template <typename Visit>
+bool LockBitmap::for_each_locked_pair(Transform map, Visit visit) const
+/** Call \c visit with each locked tile and the tile which \c map takes it to, wherever that tile is locked too, in raster order, until \c visit returns \c false.
+ *
+ * \return Whether every pair was visited, i.e. \c visit never returned \c false
+ */
+{
+	for (int row = 0; row < rows; ++row)
+	{
+		const std::span<const word_type> own = line(by_row, row);
+		const std::span<const word_type> partner = partner_of(map, row);
+		for (int word = 0; word < words_per_line; ++word)
+		{
+			for (word_type both = own[word] & partner[word]; both != 0; both &= both - 1)
+			{
+				const Point point = selection.min + Point{ row, word * word_bits + std::countr_zero(both) };
+				if (!visit(point, apply(map, point, selection)))
+					return false;
+			}
+		}
+	}
+	return true;
+}
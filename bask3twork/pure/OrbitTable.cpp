@@ -0,0 +1,65 @@
+#include "pch.h"
+#include "pure/OrbitTable.h"
+#include "pure/SelectionIterator.h"
+#include "pure/Symmetry.h"
+
+OrbitTable::OrbitTable(Symmetry sym, Selection selection)
+	: selection(selection)
+	, shared(geometry(sym, { selection.rows(), selection.columns() }))
+{}
+
+std::shared_ptr<const OrbitTable::Geometry> OrbitTable::geometry(Symmetry sym, GridSize size)
+/** The orbits of \c sym in a selection of \c size, worked out the first time they are asked for, and kept until \c ORBIT_TABLE_CACHE_ENTRIES others have been worked out.
+ * They are shared by every thread, which is why they are kept behind a lock, though it is only held to look them up.
+ */
+{
+	using Key = std::tuple<int, int, Symmetry>;
+	static std::mutex mutex;
+	static std::map<Key, std::shared_ptr<const Geometry>> cache;
+
+	const Key key{ size.rows, size.columns, sym };
+	{
+		std::scoped_lock lock(mutex);
+		if (const auto found = cache.find(key); found != cache.end())
+			return found->second;
+	}
+
+	/// Two threads may both work out the same orbits, in which case the one stored first is kept, and the other is thrown away once it is no longer used.
+	auto made = std::make_shared<const Geometry>(sym, size);
+	std::scoped_lock lock(mutex);
+	if (cache.size() >= ORBIT_TABLE_CACHE_ENTRIES)
+		cache.clear();
+	return cache.try_emplace(key, std::move(made)).first->second;
+}
+
+OrbitTable::Geometry::Geometry(Symmetry sym, GridSize size)
+{
+	std::vector<Transform> transforms;
+	if (sym % Symmetry::HoriSym)  transforms.push_back(Transform::mirror_x);
+	if (sym % Symmetry::VertSym)  transforms.push_back(Transform::mirror_y);
+	if (sym % Symmetry::Rot2Sym)  transforms.push_back(Transform::rotate_180);
+	if (sym % Symmetry::Rot4Sym)  transforms.insert(transforms.end(), { Transform::rotate_90, Transform::rotate_270 });
+	if (sym % Symmetry::FwdDiag)  transforms.push_back(Transform::mirror_forward_diagonal);
+	if (sym % Symmetry::BackDiag) transforms.push_back(Transform::mirror_backward_diagonal);
+	image_count = transforms.size();
+
+	/// Walk the selection in raster order, making each cell which is not the image of an earlier one into a representative.
+	const Selection selection = { { 0, 0 }, { size.rows - 1, size.columns - 1 } };
+	std::vector<bool> covered(static_cast<std::size_t>(size.area()));
+	const auto covered_at = [&](Point p) { return covered[static_cast<std::size_t>(p.i) * size.columns + p.j]; };
+
+	for (const Point p : SelectionRange(selection))
+	{
+		if (covered_at(p))
+			continue;
+
+		covered_at(p) = true;
+		representatives.push_back(p);
+		for (const Transform transform : transforms)
+		{
+			const Point image = apply(transform, p, selection);
+			covered_at(image) = true;
+			all_images.push_back({ image, transform });
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <memory>
+#include <ranges>
+#include <span>
+#include <vector>
+#include "Forward.h"
+#include "pure/Selection.h"
+#include "pure/Transform.h"
+/// \file
+
+/// Where one cell of an orbit lies, and how its glyph is transformed from the glyph of the orbit's representative
+struct OrbitImage
+{
+	Point point;
+	Transform transform;
+};
+
+/** The orbits of a symmetry within a selection, so that a generator only has to visit one cell of each, and a locked cell can be copied to the rest of its orbit by Knot::make_base_glyphs().
+ *
+ * The representative of each orbit is its first cell in raster order, and the representatives are kept in raster order too.
+ * Every representative has the same number of images, one for each \c Transform the symmetry implies other than \c Transform::identity,
+ * in the same order that Knot::tryGenerating() has always written them. A cell on a mirror line or at the centre of a rotation is its own image.
+ *
+ * The orbits only depend on the size of the selection, not where it is, so they are worked out once for each size and symmetry, as offsets from the upper left corner,
+ * and shared between every table of that size and symmetry, up to \c ORBIT_TABLE_CACHE_ENTRIES of them. Each table only adds its own corner to the offsets.
+ */
+class OrbitTable
+{
+public:
+	OrbitTable(Symmetry sym, Selection selection);
+
+	Selection selection;
+
+	std::size_t size() const { return shared->representatives.size(); }
+	Point representative(std::size_t orbit) const { return selection.min + shared->representatives[orbit]; }
+	auto images(std::size_t orbit) const { return offset_images(orbit) | std::views::transform([corner = selection.min](OrbitImage image) { image.point += corner; return image; }); }
+
+private:
+	/// The orbits of one size of selection and one symmetry, shared between tables
+	struct Geometry
+	{
+		std::vector<Point> representatives;   ///< As offsets from the upper left corner
+		std::vector<OrbitImage> all_images;   ///< The images of every representative, \c image_count at a time, as offsets from the upper left corner
+		std::size_t image_count = 0;
+
+		Geometry(Symmetry sym, GridSize size);
+	};
+
+	std::shared_ptr<const Geometry> shared;
+
+	std::span<const OrbitImage> offset_images(std::size_t orbit) const { return std::span(shared->all_images).subspan(orbit * shared->image_count, shared->image_count); }
+	static std::shared_ptr<const Geometry> geometry(Symmetry sym, GridSize size);
+};
+
+/* OrbitTable */
+/** \fn OrbitTable::images(std::size_t orbit) const
+ * The images of the representative of \c orbit, other than itself, as a view which adds the upper left corner of the selection to each one as it is read.
+ */
@@ -0,0 +1,24 @@
+#pragma once
+#include "pure/GridSize.h"
+
+/// The ways in which a knot can repeat across a selection, on top of its \c Symmetry
+enum class Repeat
+{
+	none,         ///< The knot does not repeat
+	translate,    ///< The knot repeats unchanged every \c Pattern::period, both down and across
+	glide_across, ///< As \c translate, but each repeat from left to right is also mirrored across the horizontal centre line of the selection
+	glide_down,   ///< As \c translate, but each repeat from top to bottom is also mirrored across the vertical centre line of the selection
+};
+
+/** How a knot repeats across a selection, so that only one fundamental tile of it has to be generated, and every other cell is a copy of it.
+ *
+ * Each repeat is a step of \c period, followed by a mirror for a glide, which is then combined with the transforms of the \c Symmetry about the centre of the selection.
+ * Together, these give the wallpaper groups whose translations line up with the grid, such as p1 from \c Repeat::translate alone, pg from a glide,
+ * pm and pmm from the reflection symmetries, p2 and p4 from the rotational ones, and pgg from a glide with 2-way rotational symmetry.
+ * The pattern only matches up across a wrapped edge if \c period divides the size of the grid, as it would for a wallpaper.
+ */
+struct Pattern
+{
+	Repeat repeat = Repeat::none;
+	GridSize period = { 4, 4 }; ///< The number of rows and columns after which the knot repeats
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <random>
+/// \file
+
+/** The xoshiro256** random engine, which is several times faster than \c std::mt19937 to advance, and takes 32 bytes rather than 5 kilobytes of state.
+ *
+ * The state is filled from a seed and a stream number by splitmix64, so that a seed gives a whole family of independent streams,
+ * such as one for each thread or attempt, and the same seed and stream always give the same numbers on every platform.
+ * Drawing is done by Xoshiro256::below() and Xoshiro256::unit(), rather than by the standard distributions, whose results differ between standard libraries.
+ */
+class Xoshiro256
+{
+public:
+	using result_type = std::uint64_t;
+
+	explicit constexpr Xoshiro256(std::uint64_t seed, std::uint64_t stream = 0)
+	{
+		std::uint64_t mixer = seed ^ splitmix(stream + 0x6A09E667F3BCC909);
+		for (std::uint64_t& word : state)
+			word = splitmix(mixer += 0x9E3779B97F4A7C15);
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT64_MAX; }
+
+	constexpr result_type operator()()
+	{
+		const std::uint64_t result = std::rotl(state[1] * 5, 7) * 9;
+		const std::uint64_t shifted = state[1] << 17;
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= shifted;
+		state[3] = std::rotl(state[3], 45);
+		return result;
+	}
+
+	/// A number from \c 0 up to but not including \c bound, which must be from 1 to \c UINT32_MAX, each equally likely, by Lemire's multiply and shift
+	constexpr std::size_t below(std::size_t bound)
+	{
+		const std::uint32_t range = static_cast<std::uint32_t>(bound);
+		std::uint64_t product = ((*this)() >> 32) * range;
+		if (static_cast<std::uint32_t>(product) < range)
+		{
+			const std::uint32_t threshold = (0u - range) % range;
+			while (static_cast<std::uint32_t>(product) < threshold)
+				product = ((*this)() >> 32) * range;
+		}
+		return static_cast<std::size_t>(product >> 32);
+	}
+
+	/// A number from \c 0 up to but not including \c 1, from the top 53 bits of the next number
+	constexpr double unit() { return static_cast<double>((*this)() >> 11) * 0x1.0p-53; }
+
+private:
+	std::array<std::uint64_t, 4> state{};
+
+	static constexpr std::uint64_t splitmix(std::uint64_t z)
+	{
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		return z ^ (z >> 31);
+	}
+};
+
+/// The random engine which every generating method draws from, so that it can be swapped for any other engine with the same members
+using Rng = Xoshiro256;
+
+/// A seed drawn from \c std::random_device, for when no seed has been chosen
+inline std::uint64_t fresh_seed()
+{
+	std::random_device device;
+	return (std::uint64_t{ device() } << 32) | device();
+}
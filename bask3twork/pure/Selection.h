@@ -1,6 +1,7 @@
 #pragma once
 #include "pure/CornerMovement.h"
 #include "pure/GridSize.h"
+#include <span>
 
 struct Point
 {
@@ -88,6 +89,10 @@ struct Selection
 	Selection left_column()  const { return { { min.i, min.j }, { max.i, min.j } }; }
 	Selection right_column() const { return { { min.i, max.j }, { max.i, max.j } }; }
 
+	/// The cells of this selection within \c row, one row of a grid whose rows are each contiguous, such as a row of \c Tiles or GlyphGrid::row()
+	template <typename Row>
+	auto within(Row&& row) const { return std::span(row).subspan(static_cast<std::size_t>(min.j), static_cast<std::size_t>(columns())); }
+
 	void normalize()
 	{
 		if (min.i > max.i)
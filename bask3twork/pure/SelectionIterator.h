@@ -1,42 +1,59 @@
 #pragma once
 #include "pure/CornerMovement.h"
 #include "pure/Selection.h"
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <span>
 #include <stdexcept>
 #include <vector>
 
 struct SelectionSentinel {};
 
+/** An iterator over the cells of a selection, starting at one corner and moving along its rows or columns, as given by a \c CornerMovement.
+ *
+ * Each cell is worked out from its index, so the iterator has random access, as given by its \c iterator_concept.
+ * Cells are read by value, since they are worked out rather than stored, so as with \c std::views::iota,
+ * its \c iterator_category is only that of an input iterator, which is all that a prvalue \c reference allows.
+ * For the algorithms of \c std with an execution policy, which need more than that, see SelectionRange::cells().
+ */
 class SelectionIterator
 {
 	using Self = SelectionIterator;
 
 public:
-	using iterator_category = std::bidirectional_iterator_tag;
-	using difference_type = std::ptrdiff_t; // Unused
+	using iterator_category = std::input_iterator_tag;
+	using iterator_concept  = std::random_access_iterator_tag;
+	using difference_type   = std::ptrdiff_t;
 	using value_type = Point;
-	using pointer    = const Point*;
-	using reference  = const Point&;
+	using pointer    = void;
+	using reference  = Point;
 
 	SelectionIterator() = default;
 
-	SelectionIterator(Selection selection, CornerMovement type)
+	SelectionIterator(Selection selection, CornerMovement type, difference_type index = 0)
 		: selection(selection)
 	{
 		set_points(type);
-		static_assert(std::bidirectional_iterator<Self>);
-		static_assert(!std::random_access_iterator<Self>);
+		move_to(index);
+		static_assert(std::random_access_iterator<Self>);
 	}
 
 	friend bool operator==(const Self& lhs, const Self& rhs)
 	{
-		if (lhs.constants() != rhs.constants())
-			throw std::logic_error("Trying to compare iterators into 2 different grid ranges.");
-		return lhs.current == rhs.current;
+		check_same_range(lhs, rhs);
+		return lhs.index == rhs.index;
+	}
+
+	friend std::strong_ordering operator<=>(const Self& lhs, const Self& rhs)
+	{
+		check_same_range(lhs, rhs);
+		return lhs.index <=> rhs.index;
 	}
 
 	bool operator==(SelectionSentinel) const
 	{
-		return !selection.contains(current);
+		return index == size();
 	}
 
 	reference operator*() const
@@ -44,12 +61,23 @@ public:
 		return current;
 	}
 
+	reference operator[](difference_type offset) const
+	{
+		return point_at(index + offset);
+	}
+
 	Self& operator++()
 	{
-		current += movement;
-		if (!selection.contains(current))
+		++index;
+		if (++along < run)
+		{
+			current += movement;
+		}
+		else
 		{
-			current += movement_2;
+			along = 0;
+			line_start += stride;
+			current = line_start;
 		}
 		return *this;
 	}
@@ -63,11 +91,7 @@ public:
 
 	Self& operator--()
 	{
-		current -= movement;
-		if (!selection.contains(current))
-		{
-			current -= movement_2;
-		}
+		move_to(index - 1);
 		return *this;
 	}
 
@@ -78,46 +102,92 @@ public:
 		return temp;
 	}
 
+	Self& operator+=(difference_type offset) { move_to(index + offset); return *this; }
+	Self& operator-=(difference_type offset) { move_to(index - offset); return *this; }
+
+	friend Self operator+(Self it, difference_type offset) { return it += offset; }
+	friend Self operator+(difference_type offset, Self it) { return it += offset; }
+	friend Self operator-(Self it, difference_type offset) { return it -= offset; }
+
+	friend difference_type operator-(const Self& lhs, const Self& rhs)
+	{
+		check_same_range(lhs, rhs);
+		return lhs.index - rhs.index;
+	}
+
+	difference_type size() const
+	{
+		return static_cast<difference_type>(selection.rows()) * selection.columns();
+	}
+
 private:
 	void set_points(const CornerMovement type)
 	{
 		using enum Corner;
 		using enum Movement;
 
-		current = selection.corner(type.corner);
+		corner = selection.corner(type.corner);
 		movement = Point::movement(type.movement);
 
 		switch (type)
 		{
 		break; case upper_left | down:
-			movement_2 = { -selection.rows(), 1 };
+			stride = Point::right();
 		break; case upper_left | right:
-			movement_2 = { 1, -selection.columns() };
+			stride = Point::down();
 		break; case upper_right | down:
-			movement_2 = { -selection.rows(), -1 };
+			stride = Point::left();
 		break; case upper_right | left:
-			movement_2 = { 1, selection.columns() };
+			stride = Point::down();
 		break; case lower_left | up:
-			movement_2 = { selection.rows(), 1 };
+			stride = Point::right();
 		break; case lower_left | right:
-			movement_2 = { -1, -selection.columns() };
+			stride = Point::up();
 		break; case lower_right | up:
-			movement_2 = { selection.rows(), -1 };
+			stride = Point::left();
 		break; case lower_right | left:
-			movement_2 = { -1, selection.columns() };
+			stride = Point::up();
 		break; default:
 			throw std::logic_error("Incorrect combination of Corner and Movement.");
 		}
+
+		run = movement.i != 0 ? selection.rows() : selection.columns();
+	}
+
+	Point point_at(difference_type at) const
+	{
+		const int line = static_cast<int>(at / run);
+		const int step = static_cast<int>(at % run);
+		return corner + Point{ stride.i * line + movement.i * step, stride.j * line + movement.j * step };
+	}
+
+	void move_to(difference_type at)
+	{
+		index = at;
+		along = static_cast<int>(at % run);
+		line_start = point_at(at - along);
+		current = point_at(at);
+	}
+
+	static void check_same_range(const Self& lhs, const Self& rhs)
+	{
+		if (lhs.constants() != rhs.constants())
+			throw std::logic_error("Trying to compare iterators into 2 different grid ranges.");
 	}
 
 	std::tuple<const Point&, const Point&, const Selection&> constants() const
 	{
-		return std::tie(movement, movement_2, selection);
+		return std::tie(movement, stride, selection);
 	}
 
+	difference_type index = 0;
+	int along = 0;                 ///< How far \c current is along its row or column
+	int run = 1;                   ///< The length of each row or column which is walked along
 	Point current = { -1, -1 };
+	Point line_start = { -1, -1 }; ///< The first cell of the row or column holding \c current
+	Point corner = { -1, -1 };
 	Point movement = { 1 << 16, 1 << 16 };
-	Point movement_2 = { 1 << 16, 1 << 16 };
+	Point stride = { 1 << 16, 1 << 16 }; ///< From the start of one row or column to the start of the next
 
 	Selection selection = { { -1, -1 }, { -1, -1 } };
 };
@@ -130,14 +200,31 @@ public:
 	SelectionRange(Selection selection, CornerMovement type = Corner::upper_left | Movement::right)
 		: selection(selection), type(type)
 	{
-		static_assert(std::ranges::bidirectional_range<SelectionRange>);
-		static_assert(!std::ranges::random_access_range<SelectionRange>);
+		static_assert(std::ranges::random_access_range<SelectionRange>);
+		static_assert(std::ranges::common_range<SelectionRange>);
 	}
 
 	auto begin() const { return SelectionIterator{ selection, type }; }
-	auto end()   const { return SelectionSentinel{}; }
+	auto end()   const { return SelectionIterator{ selection, type, size() }; }
+	std::ptrdiff_t size() const { return static_cast<std::ptrdiff_t>(selection.rows()) * selection.columns(); }
+
+	std::span<const Point> cells(std::vector<Point>& storage) const
+	{
+		storage.resize(static_cast<std::size_t>(size()));
+		std::copy(begin(), end(), storage.begin());
+		return storage;
+	}
 
 private:
 	Selection selection;
 	CornerMovement type;
 };
+
+/* SelectionRange */
+/** \fn SelectionRange::end() const
+ * The end of the range, as an iterator rather than a \c SelectionSentinel, so that the range is a common range, and can be passed to the algorithms of \c std which take a pair of input iterators.
+ */
+/** \fn SelectionRange::cells(std::vector<Point>& storage) const
+ * Every cell of the range, in its order, written out into \c storage, whose capacity is reused.
+ * The span has contiguous iterators, so unlike the range itself, it can be passed to the algorithms of \c std with an execution policy, in any of the eight orders.
+ */
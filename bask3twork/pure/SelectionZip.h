@@ -7,11 +7,12 @@ class SelectionZipIterator
 	using Self = SelectionZipIterator;
 
 public:
-	using iterator_category = std::bidirectional_iterator_tag;
-	using difference_type = std::ptrdiff_t; // Unused
-	using value_type = std::pair<const Point&, const Point&>;
-	using pointer    = std::pair<const Point&, const Point&>;
-	using reference  = std::pair<const Point&, const Point&>;
+	using iterator_category = std::input_iterator_tag; ///< Only an input iterator to the algorithms of \c std which take a pair of iterators, since pairs are read by value, see \c SelectionIterator
+	using iterator_concept  = std::random_access_iterator_tag;
+	using difference_type   = std::ptrdiff_t;
+	using value_type = std::pair<Point, Point>;
+	using pointer    = void;
+	using reference  = std::pair<Point, Point>;
 
 	SelectionZipIterator() = default;
 
@@ -19,12 +20,16 @@ public:
 		: it1(selection1, type1)
 		, it2(selection2, type2)
 	{
-		static_assert(std::bidirectional_iterator<Self>);
-		static_assert(!std::random_access_iterator<Self>);
+		static_assert(std::random_access_iterator<Self>);
 	}
 
 	friend bool operator==(const Self& lhs, const Self& rhs) = default;
 
+	friend std::strong_ordering operator<=>(const Self& lhs, const Self& rhs)
+	{
+		return lhs.it1 <=> rhs.it1;
+	}
+
 	bool operator==(SelectionSentinel) const
 	{
 		return (it1 == SelectionSentinel{}) && (it2 == SelectionSentinel{});
@@ -35,6 +40,11 @@ public:
 		return { *it1, *it2 };
 	}
 
+	reference operator[](difference_type offset) const
+	{
+		return { it1[offset], it2[offset] };
+	}
+
 	Self& operator++()
 	{
 		++it1;
@@ -63,6 +73,18 @@ public:
 		return temp;
 	}
 
+	Self& operator+=(difference_type offset) { it1 += offset; it2 += offset; return *this; }
+	Self& operator-=(difference_type offset) { it1 -= offset; it2 -= offset; return *this; }
+
+	friend Self operator+(Self it, difference_type offset) { return it += offset; }
+	friend Self operator+(difference_type offset, Self it) { return it += offset; }
+	friend Self operator-(Self it, difference_type offset) { return it -= offset; }
+
+	friend difference_type operator-(const Self& lhs, const Self& rhs)
+	{
+		return lhs.it1 - rhs.it1;
+	}
+
 private:
 	SelectionIterator it1;
 	SelectionIterator it2;
@@ -76,8 +98,7 @@ public:
 	SelectionZipRange(Selection selection1, CornerMovement type1, Selection selection2, CornerMovement type2)
 		:  selection1(selection1), type1(type1), selection2(selection2), type2(type2)
 	{
-		static_assert(std::ranges::bidirectional_range<SelectionZipRange>);
-		static_assert(!std::ranges::random_access_range<SelectionZipRange>);
+		static_assert(std::ranges::random_access_range<SelectionZipRange>);
 	}
 
 	SelectionZipRange(Selection selection, CornerMovement type1, CornerMovement type2)
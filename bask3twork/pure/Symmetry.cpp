@@ -1,7 +1,9 @@
 #include "pch.h"
 #include "pure/CornerMovement.h"
 #include "pure/Glyph.h"
+#include "pure/GlyphGrid.h"
 #include "pure/GridSize.h"
+#include "pure/LockBitmap.h"
 #include "pure/Selection.h"
 #include "pure/SelectionZip.h"
 #include "pure/Symmetry.h"
@@ -9,6 +11,29 @@
 
 
 
+namespace
+{
+	/// One way for the locked tiles to allow a symmetry, that the glyph of each tile is the glyph of the tile \c map takes it to, transformed by \c transform.
+	/// For \c Rot4Sym, that tile is a quarter turn anticlockwise, and its glyph is turned a quarter clockwise to match.
+	struct LockingCheck
+	{
+		Symmetry sym;
+		Transform map;
+		const Glyph* GlyphsTransformed::* transform;
+		bool square_only;
+	};
+
+	constexpr std::array<LockingCheck, 6> locking_checks =
+	{
+		LockingCheck{ Symmetry::HoriSym,  Transform::mirror_x,                 &Glyph::mirror_x,                 false },
+		LockingCheck{ Symmetry::VertSym,  Transform::mirror_y,                 &Glyph::mirror_y,                 false },
+		LockingCheck{ Symmetry::Rot2Sym,  Transform::rotate_180,               &Glyph::rotate_180,               false },
+		LockingCheck{ Symmetry::Rot4Sym,  Transform::rotate_270,               &Glyph::rotate_90,                true },
+		LockingCheck{ Symmetry::FwdDiag,  Transform::mirror_forward_diagonal,  &Glyph::mirror_forward_diagonal,  true },
+		LockingCheck{ Symmetry::BackDiag, Transform::mirror_backward_diagonal, &Glyph::mirror_backward_diagonal, true },
+	};
+}
+
 class SymmetryChecker
 {
 public:
@@ -16,6 +41,11 @@ public:
 		: glyphs(&glyphs), tiles(&tiles), selection(selection)
 	{}
 
+	/// Only for checking connections, which do not depend on the locking
+	SymmetryChecker(const Glyphs& glyphs, Selection selection)
+		: glyphs(&glyphs), tiles(nullptr), selection(selection)
+	{}
+
 	Symmetry connections(GridSize size) const;
 	Symmetry locking(Symmetry connection_sym) const; // The parameter is used for short circuiting
 
@@ -33,18 +63,9 @@ private:
 	bool has_forward_diagonal_connections() const;
 	bool has_backward_diagonal_connections() const;
 
-	template <const Glyph* GlyphsTransformed::* transform>
-	bool check_locking(const SelectionZipRange& range) const;
+	bool check_locking(const LockBitmap& locks, const LockingCheck& check) const;
 
-	bool has_mirror_x_locking() const;
-	bool has_mirror_y_locking() const;
-	bool has_rotate_180_locking() const;
-	bool has_rotate_90_locking() const;
-	bool has_forward_diagonal_locking() const;
-	bool has_backward_diagonal_locking() const;
-
-	const Glyph* glyph(Point p) const { return (*glyphs)[p.i][p.j]; }
-	const Tile* tile(Point p) const { return &((*tiles)[p.i][p.j]); }
+	const Glyph* glyph(Point p) const { return (*glyphs)[p]; }
 
 private:
 	const Glyphs* glyphs;
@@ -59,6 +80,100 @@ Symmetry check_symmetry(const Glyphs& glyphs, const Tiles& tiles, Selection sele
 	return checker.locking(connections);
 }
 
+Symmetry SymmetryTracker::symmetry(const Glyphs& glyphs, const Tiles& tiles, Selection selection, GridSize size)
+{
+	if (counted != selection || this->size != size)
+	{
+		counted = selection;
+		this->size = size;
+		glyphs_changed(glyphs);
+
+		mismatches.fill(0);
+		const LockBitmap locks(tiles, selection);
+		for (std::size_t check = 0; check < locking_checks.size(); ++check)
+		{
+			if (locking_checks[check].square_only && !selection.is_square())
+				continue;
+			locks.for_each_locked_pair(locking_checks[check].map, [&](Point p, Point q)
+				{
+					mismatches[check] += glyphs[p] != (glyphs[q]->*locking_checks[check].transform);
+					return true;
+				});
+		}
+	}
+
+	Symmetry allowed = Symmetry::AnySym;
+	for (std::size_t check = 0; check < locking_checks.size(); ++check)
+	{
+		if (connections % locking_checks[check].sym && mismatches[check] == 0)
+			allowed = allowed | locking_checks[check].sym;
+	}
+	return allowed;
+}
+
+void SymmetryTracker::lock_changed(const Glyphs& glyphs, const Tiles& tiles, Point point)
+{
+	if (!counted || !counted->contains(point))
+		return;
+
+	const int sign = tiles[point.i][point.j].locked() ? 1 : -1;
+	for (std::size_t check = 0; check < locking_checks.size(); ++check)
+	{
+		if (!locking_checks[check].square_only || counted->is_square())
+			mismatches[check] += sign * count_mismatches(glyphs, tiles, check, point);
+	}
+}
+
+int SymmetryTracker::count_mismatches(const Glyphs& glyphs, const Tiles& tiles, std::size_t check, Point point) const
+/** The pairs of one check which \c point is part of, and which would not fit if it were locked, whether or not it is.
+ *
+ * Since the pairs are ordered, \c point is the first tile of one pair and the second tile of another, which are the same pair only if \c point maps to itself.
+ */
+{
+	const LockingCheck& locking = locking_checks[check];
+	const auto mismatched = [&](Point p, Point q)
+		{
+			const bool locked = (p == point || tiles[p.i][p.j].locked()) && (q == point || tiles[q.i][q.j].locked());
+			return locked && glyphs[p] != (glyphs[q]->*locking.transform);
+		};
+
+	const Point image = apply(locking.map, point, *counted);
+	const Point preimage = apply(inverse(locking.map), point, *counted);
+	return mismatched(point, image) + (preimage != point && mismatched(preimage, point));
+}
+
+void SymmetryTracker::glyphs_changed(const Glyphs& glyphs)
+{
+	if (counted)
+		connections = SymmetryChecker(glyphs, *counted).connections(size);
+}
+
+std::vector<Transform> symmetry_group(Symmetry sym)
+{
+	std::vector<Transform> generators;
+	if (sym % Symmetry::HoriSym)  generators.push_back(Transform::mirror_x);
+	if (sym % Symmetry::VertSym)  generators.push_back(Transform::mirror_y);
+	if (sym % Symmetry::Rot2Sym)  generators.push_back(Transform::rotate_180);
+	if (sym % Symmetry::Rot4Sym)  generators.push_back(Transform::rotate_90);
+	if (sym % Symmetry::FwdDiag)  generators.push_back(Transform::mirror_forward_diagonal);
+	if (sym % Symmetry::BackDiag) generators.push_back(Transform::mirror_backward_diagonal);
+
+	// Close the generators under composition, which takes at most a few passes since the group has at most 8 elements
+	std::vector<Transform> group = { Transform::identity };
+	for (std::size_t index = 0; index < group.size(); ++index)
+	{
+		for (Transform generator : generators)
+		{
+			const Transform element = compose(group[index], generator);
+			if (std::ranges::find(group, element) == group.end())
+				group.push_back(element);
+		}
+	}
+	return group;
+}
+
+
+
 Symmetry SymmetryChecker::connections(GridSize size) const
 {
 	if (selection.is_full_selection(size))
@@ -87,13 +202,14 @@ Symmetry SymmetryChecker::connections(GridSize size) const
 
 Symmetry SymmetryChecker::locking(Symmetry connection_sym) const
 {
-	return Symmetry::AnySym
-		| (connection_sym % Symmetry::HoriSym  ? Symmetry::HoriSym  * has_mirror_x_locking()          : Symmetry::Nothing)
-		| (connection_sym % Symmetry::VertSym  ? Symmetry::VertSym  * has_mirror_y_locking()          : Symmetry::Nothing)
-		| (connection_sym % Symmetry::Rot2Sym  ? Symmetry::Rot2Sym  * has_rotate_180_locking()        : Symmetry::Nothing)
-		| (connection_sym % Symmetry::Rot4Sym  ? Symmetry::Rot4Sym  * has_rotate_90_locking()         : Symmetry::Nothing)
-		| (connection_sym % Symmetry::FwdDiag  ? Symmetry::FwdDiag  * has_forward_diagonal_locking()  : Symmetry::Nothing)
-		| (connection_sym % Symmetry::BackDiag ? Symmetry::BackDiag * has_backward_diagonal_locking() : Symmetry::Nothing);
+	const LockBitmap locks(*tiles, selection);
+	Symmetry allowed = Symmetry::AnySym;
+	for (const LockingCheck& check : locking_checks)
+	{
+		if (connection_sym % check.sym && check_locking(locks, check))
+			allowed = allowed | check.sym;
+	}
+	return allowed;
 }
 
 
@@ -109,15 +225,9 @@ bool SymmetryChecker::check_connections(const SelectionZipRange& range) const
 	return true;
 }
 
-template <const Glyph* GlyphsTransformed::* transform>
-bool SymmetryChecker::check_locking(const SelectionZipRange& range) const
+bool SymmetryChecker::check_locking(const LockBitmap& locks, const LockingCheck& check) const
 {
-	for (const auto& [p1, p2] : range)
-	{
-		if (tile(p1)->locked() && tile(p2)->locked() && glyph(p1) != (glyph(p2)->*transform))
-			return false;
-	}
-	return true;
+	return locks.for_each_locked_pair(check.map, [&](Point p1, Point p2) { return glyph(p1) == (glyph(p2)->*check.transform); });
 }
 
 
@@ -161,35 +271,3 @@ bool SymmetryChecker::has_backward_diagonal_connections() const
 		&& check_connections<mirror_backward_diagonal, &Glyph::right, &Glyph::down> ({ selection.right_column(), upper_right | down, selection.lower_row(), lower_left | right });
 }
 
-
-
-bool SymmetryChecker::has_mirror_x_locking() const
-{
-	return check_locking<&Glyph::mirror_x>({ selection, upper_left | right, lower_left | right });
-}
-
-bool SymmetryChecker::has_mirror_y_locking() const
-{
-	return check_locking<&Glyph::mirror_y>({ selection, upper_left | down, upper_right | down });
-}
-
-bool SymmetryChecker::has_rotate_180_locking() const
-{
-	return check_locking<&Glyph::rotate_180>({ selection, upper_left | right, lower_right | left });
-}
-
-bool SymmetryChecker::has_rotate_90_locking() const
-{
-	return check_locking<&Glyph::rotate_90>({ selection, upper_left | right, lower_left | up })
-		&& check_locking<&Glyph::rotate_90>({ selection, upper_right | down, upper_left | right });
-}
-
-bool SymmetryChecker::has_forward_diagonal_locking() const
-{
-	return check_locking<&Glyph::mirror_forward_diagonal>({ selection, upper_left | right, lower_right | up });
-}
-
-bool SymmetryChecker::has_backward_diagonal_locking() const
-{
-	return check_locking<&Glyph::mirror_backward_diagonal>({ selection, upper_right | left, lower_left | up });
-}
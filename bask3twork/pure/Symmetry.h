@@ -1,4 +1,8 @@
 #pragma once
+#include <array>
+#include <optional>
+#include <vector>
+#include "pure/Transform.h"
 #include "pure/UsableEnum.h"
 #include "Forward.h"
 
@@ -30,3 +34,44 @@ enum class Symmetry
 template <> struct opt_into_enum_operations<Symmetry> : std::true_type {};
 
 Symmetry check_symmetry(const Glyphs& glyphs, const Tiles& tiles, Selection selection, GridSize size);
+
+/// Every \c Transform which maps a knot with this symmetry onto itself, starting with \c Transform::identity
+std::vector<Transform> symmetry_group(Symmetry sym);
+
+/** The symmetries which check_symmetry() allows in one selection, kept up to date as the knot and its locking change, rather than checked again from scratch each time.
+ *
+ * The symmetries allowed by the glyphs around the selection only depend on its edges, so they are checked again whenever the glyphs change.
+ * Those allowed by the locked tiles depend on every pair of tiles which a symmetry maps onto each other, so the pairs which do not fit are counted instead,
+ * and locking or unlocking one tile only counts again the few pairs which it is part of. A symmetry is allowed while none of its pairs are left.
+ *
+ * Anything else, such as a new selection or locking many tiles at once, counts every pair again the next time SymmetryTracker::symmetry() is called.
+ */
+class SymmetryTracker
+{
+public:
+	Symmetry symmetry(const Glyphs& glyphs, const Tiles& tiles, Selection selection, GridSize size);
+
+	void lock_changed(const Glyphs& glyphs, const Tiles& tiles, Point point);
+	void glyphs_changed(const Glyphs& glyphs);
+	void reset() { counted.reset(); } ///< Counts everything again the next time, for when the locking changes other than one tile at a time
+
+private:
+	std::optional<Selection> counted; ///< The selection whose pairs are counted, or \c std::nullopt if they have to be counted again
+	GridSize size = {};
+	Symmetry connections = Symmetry::Nothing;  ///< The symmetries allowed by the glyphs around the selection
+	std::array<int, 6> mismatches = {};        ///< The pairs of locked tiles which do not fit each symmetry, in the same order as the checks in Symmetry.cpp
+
+	int count_mismatches(const Glyphs& glyphs, const Tiles& tiles, std::size_t check, Point point) const;
+};
+
+/* SymmetryTracker */
+/** \fn SymmetryTracker::symmetry(const Glyphs& glyphs, const Tiles& tiles, Selection selection, GridSize size)
+ * The same as check_symmetry(), counting every pair again only if the selection or size is not the one counted last.
+ */
+/** \fn SymmetryTracker::lock_changed(const Glyphs& glyphs, const Tiles& tiles, Point point)
+ * Called after locking or unlocking the tile at \c point, count again only the pairs of tiles which it is part of.
+ */
+/** \fn SymmetryTracker::glyphs_changed(const Glyphs& glyphs)
+ * Called after changing glyphs which are not locked, check the edges of the selection again.
+ * Locked glyphs have to stay as they are, since the pairs which do not fit are not counted again, as when generating or clearing.
+ */
@@ -0,0 +1,82 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "pure/Selection.h"
+/// \file
+
+/// The 8 symmetries of a square, in the same order as the members of \c GlyphsTransformed.
+/// Unlike the member pointers, these can be composed and inverted, and can move a \c Point around a \c Selection.
+enum class Transform : std::uint8_t
+{
+	identity,
+	rotate_90,
+	rotate_180,
+	rotate_270,
+	mirror_x,
+	mirror_y,
+	mirror_forward_diagonal,
+	mirror_backward_diagonal,
+};
+
+constexpr std::size_t TransformCount = 8;
+
+/// The linear part of a \c Transform, acting on (i, j) offsets from the centre of a selection,
+/// where \c i increases downward and \c j increases rightward.
+struct TransformMatrix
+{
+	int ii, ij;
+	int ji, jj;
+
+	constexpr Point operator()(Point p) const { return { ii * p.i + ij * p.j, ji * p.i + jj * p.j }; }
+	friend constexpr bool operator==(TransformMatrix, TransformMatrix) = default;
+};
+
+/// The \c TransformMatrix of each \c Transform, in the same order
+constexpr std::array<TransformMatrix, TransformCount> TransformMatrices =
+{
+	TransformMatrix{  1,  0,   0,  1 }, // identity
+	TransformMatrix{  0,  1,  -1,  0 }, // rotate_90 clockwise, (i, j) -> (j, -i)
+	TransformMatrix{ -1,  0,   0, -1 }, // rotate_180
+	TransformMatrix{  0, -1,   1,  0 }, // rotate_270 clockwise, (i, j) -> (-j, i)
+	TransformMatrix{ -1,  0,   0,  1 }, // mirror_x, across the horizontal line
+	TransformMatrix{  1,  0,   0, -1 }, // mirror_y, across the vertical line
+	TransformMatrix{  0, -1,  -1,  0 }, // mirror_forward_diagonal, across "/"
+	TransformMatrix{  0,  1,   1,  0 }, // mirror_backward_diagonal, across "\"
+};
+
+constexpr TransformMatrix matrix_of(Transform t) { return TransformMatrices[static_cast<std::size_t>(t)]; }
+
+/// The \c Transform equal to applying \c first and then \c second
+constexpr Transform compose(Transform first, Transform second)
+{
+	const TransformMatrix a = matrix_of(first);
+	const TransformMatrix b = matrix_of(second);
+	const TransformMatrix product =
+	{
+		b.ii * a.ii + b.ij * a.ji, b.ii * a.ij + b.ij * a.jj,
+		b.ji * a.ii + b.jj * a.ji, b.ji * a.ij + b.jj * a.jj,
+	};
+	for (std::size_t t = 0; t < TransformCount; ++t)
+		if (TransformMatrices[t] == product)
+			return static_cast<Transform>(t);
+	throw;
+}
+
+constexpr Transform inverse(Transform t)
+{
+	for (std::size_t u = 0; u < TransformCount; ++u)
+		if (compose(t, static_cast<Transform>(u)) == Transform::identity)
+			return static_cast<Transform>(u);
+	throw;
+}
+
+/// The image of \c point under \c t, taken around the centre of \c selection.
+/// The transforms other than \c identity, \c rotate_180, \c mirror_x, and \c mirror_y require a square selection.
+constexpr Point apply(Transform t, Point point, Selection selection)
+{
+	// Work in doubled coordinates, so that the centre of an even-sized selection is still a lattice point
+	const Point centre2 = selection.min + selection.max;
+	const Point offset2 = { 2 * point.i - centre2.i, 2 * point.j - centre2.j };
+	const Point image2 = matrix_of(t)(offset2);
+	return { (image2.i + centre2.i) / 2, (image2.j + centre2.j) / 2 };
+}
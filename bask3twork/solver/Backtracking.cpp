@@ -0,0 +1,252 @@
+#include "pch.h"
+#include "pure/Random.h"
+#include "solver/Backtracking.h"
+#include "solver/Problem.h"
+#include "Constants.h"
+
+namespace
+{
+	/// Adds the elements of \c from into the sorted \c into, other than \c except
+	void merge_into(std::vector<int>& into, const std::vector<int>& from, int except = -1)
+	{
+		for (const int depth : from)
+		{
+			if (depth == except)
+				continue;
+			const auto it = std::ranges::lower_bound(into, depth);
+			if (it == into.end() || *it != depth)
+				into.insert(it, depth);
+		}
+	}
+}
+
+Backtracker::Backtracker(const Problem& problem, std::vector<GlyphSet> domains)
+	: problem(&problem)
+	, domains(std::move(domains))
+	, order(this->domains.size())
+	, trail_marks(this->domains.size())
+	, untried(this->domains.size())
+	, conflicts(this->domains.size())
+	, in_queue(this->domains.size(), false)
+	, marked(this->domains.size(), false)
+{
+	for (int variable = 0; variable < (int)order.size(); ++variable)
+		order[variable] = variable;
+}
+
+void Backtracker::narrow(int variable, const GlyphSet& domain, int cause, int depth)
+/// Records the current state of \c variable on the trail, then narrows its domain to \c domain.
+{
+	trail.push_back({ variable, domains[variable], cause, depth });
+	domains[variable] = domain;
+
+	if (!in_queue[variable])
+	{
+		in_queue[variable] = true;
+		queue.push_back(variable);
+	}
+}
+
+std::vector<int> Backtracker::explain(int variable, std::size_t trail_end)
+{
+	std::vector<int> depths;
+	std::vector<int> touched = { variable };
+	marked[variable] = true;
+
+	for (std::size_t index = trail_end; index-- > 0;)
+	{
+		const TrailEntry& entry = trail[index];
+		if (!marked[entry.variable])
+			continue;
+
+		if (entry.cause == -1)
+			merge_into(depths, { entry.depth });
+		else if (!marked[entry.cause])
+		{
+			marked[entry.cause] = true;
+			touched.push_back(entry.cause);
+		}
+	}
+
+	for (const int v : touched)
+		marked[v] = false;
+	return depths;
+}
+
+std::optional<std::vector<int>> Backtracker::assign(int depth, std::size_t glyph)
+{
+	GlyphSet value;
+	value.insert(glyph);
+	narrow(order[depth], value, -1, depth);
+
+	/// Then revise the edges of every narrowed variable until nothing changes, as in Propagator::propagate().
+	std::optional<std::vector<int>> conflict;
+	while (!queue.empty() && !conflict)
+	{
+		const int variable = queue.back();
+		queue.pop_back();
+		in_queue[variable] = false;
+
+		for (const int e : problem->edges_of[variable])
+		{
+			const ProblemEdge& edge = problem->edges[e];
+			const int other = edge.a == variable ? edge.b : edge.a;
+
+			const GlyphSet narrowed = domains[other] & supported_by(edge, variable, domains[variable]);
+			if (narrowed == domains[other])
+				continue;
+
+			narrow(other, narrowed, variable, depth);
+			if (narrowed.empty())
+			{
+				conflict = explain(other, trail.size());
+				break;
+			}
+		}
+	}
+
+	for (const int variable : queue)
+		in_queue[variable] = false;
+	queue.clear();
+	return conflict;
+}
+
+void Backtracker::undo(int depth)
+/// Restores every variable narrowed by the assignments at \c depth and beyond.
+{
+	while (trail.size() > trail_marks[depth])
+	{
+		domains[trail.back().variable] = trail.back().domain;
+		trail.pop_back();
+	}
+}
+
+std::optional<std::vector<std::size_t>> Backtracker::solve(Rng& rng, int max_backtracks, const Progress& progress, std::stop_token stop, Deadline deadline)
+{
+	const int count = (int)order.size();
+	std::vector<std::size_t> values(count);
+
+	const auto enter = [&](int depth)
+		{
+			trail_marks[depth] = trail.size();
+			untried[depth] = domains[order[depth]];
+			conflicts[depth].clear();
+		};
+
+	int depth = 0;
+	if (count != 0)
+		enter(0);
+
+	while (depth < count)
+	{
+		if (deadline != Deadline::max() && std::chrono::steady_clock::now() > deadline)
+			return std::nullopt;
+
+		/// \b (1) Try the untried glyphs of the current variable in a random order, until one can be propagated without emptying a domain.
+		///	Each one that fails adds the reasons for its failure to the conflicts of this depth.
+		bool consistent = false;
+		while (!untried[depth].empty() && !consistent)
+		{
+			const std::size_t glyph = problem->choose(untried[depth], rng);
+			untried[depth].erase(glyph);
+
+			const std::optional<std::vector<int>> conflict = assign(depth, glyph);
+			consistent = !conflict;
+			if (consistent)
+				values[order[depth]] = glyph;
+			else
+			{
+				merge_into(conflicts[depth], *conflict, depth);
+				undo(depth);
+			}
+		}
+
+		/// \b (2) If one can, move on to the next variable.
+		if (consistent)
+		{
+			if (++depth < count)
+				enter(depth);
+			continue;
+		}
+
+		/// \b (3) Otherwise, the dead end is explained by the conflicts of this depth, along with whatever explains the glyphs this variable had already lost.
+		///	Jump back to the latest of those depths, which inherits the rest of the explanation, and undo every assignment from there on.
+		///	If nothing explains the dead end, then it happens no matter what, and the search is exhausted.
+		if (++_backtracks > max_backtracks || stop.stop_requested())
+			return std::nullopt;
+		if (progress && _backtracks % ATTEMPTS_DISPLAY_INCREMENT == 0)
+			progress(_backtracks);
+
+		std::vector<int> reasons = conflicts[depth];
+		merge_into(reasons, explain(order[depth], trail_marks[depth]), depth);
+		if (reasons.empty())
+		{
+			_exhausted = true;
+			return std::nullopt;
+		}
+
+		const int target = reasons.back();
+		merge_into(conflicts[target], reasons, target);
+		undo(target);
+		depth = target;
+	}
+
+	return values;
+}
+
+std::optional<std::vector<std::size_t>> solve_with_restarts(const Problem& problem, const std::vector<GlyphSet>& domains, Rng& rng, int max_backtracks, const Backtracker::Progress& progress, std::stop_token stop, RestartStatistics* statistics)
+{
+	struct Schedule
+	{
+		RestartSchedule kind;
+		int runs = 0;
+		long long backtracks = 0;
+
+		/// The cutoff of the next run, where the Luby sequence is found by halving down to the complete part of it which holds the run, as in MiniSat
+		long long cutoff() const
+		{
+			if (kind == RestartSchedule::geometric)
+				return static_cast<long long>(FIRST_RUN_BACKTRACKS) << std::min(runs, 32);
+
+			long long size = 1;
+			int power = 0;
+			for (; size < runs + 1; size = 2 * size + 1)
+				++power;
+			for (long long run = runs; size - 1 != run; run %= size)
+			{
+				size = (size - 1) / 2;
+				--power;
+			}
+			return static_cast<long long>(FIRST_RUN_BACKTRACKS) << power;
+		}
+	};
+	std::array<Schedule, 2> schedules = { Schedule{ RestartSchedule::geometric }, Schedule{ RestartSchedule::luby } };
+
+	int total_backtracks = 0;
+	while (total_backtracks < max_backtracks)
+	{
+		Schedule& schedule = schedules[0].backtracks <= schedules[1].backtracks ? schedules[0] : schedules[1];
+		Backtracker backtracker(problem, domains);
+		Backtracker::Progress report;
+		if (progress)
+			report = [&](int backtracks) { progress(total_backtracks + backtracks); };
+
+		std::optional<std::vector<std::size_t>> values = backtracker.solve(rng, static_cast<int>(std::min<long long>(schedule.cutoff(), max_backtracks - total_backtracks)), report, stop);
+		++schedule.runs;
+		if (statistics)
+			++statistics->runs;
+		if (values)
+		{
+			if (statistics)
+				statistics->winner = schedule.kind;
+			return values;
+		}
+
+		/// If a run exhausts every possibility, then there is no solution, so there is no point in starting over.
+		if (backtracker.exhausted() || stop.stop_requested())
+			return std::nullopt;
+		total_backtracks += backtracker.backtracks();
+		schedule.backtracks += backtracker.backtracks();
+	}
+	return std::nullopt;
+}
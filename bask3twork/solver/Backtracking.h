@@ -0,0 +1,115 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <vector>
+#include "Forward.h"
+#include "pure/GlyphSet.h"
+
+/** A complete depth-first search over the variables of a \c Problem, maintaining arc consistency and using conflict-directed backjumping.
+ *
+ * Each assignment is propagated to every domain as in \c Propagator, and every narrowing is kept on a trail along with the variable which caused it.
+ * When a variable runs out of glyphs, the trail is followed back to find the assignments responsible, and the search jumps straight back to the latest of those,
+ * rather than undoing the unrelated assignments in between one at a time, and rather than starting over from nothing.
+ */
+class Backtracker
+{
+public:
+	/// \param domains The domains to start from, usually those of a \c Propagator after Propagator::propagate() has succeeded
+	Backtracker(const Problem& problem, std::vector<GlyphSet> domains);
+
+	/// Called with the number of backtracks so far, every \c ATTEMPTS_DISPLAY_INCREMENT backtracks
+	using Progress = std::function<void(int backtracks)>;
+
+	using Deadline = std::chrono::steady_clock::time_point;
+
+	std::optional<std::vector<std::size_t>> solve(Rng& rng, int max_backtracks, const Progress& progress = {}, std::stop_token stop = {}, Deadline deadline = Deadline::max());
+
+	bool exhausted() const { return _exhausted; }
+	int backtracks() const { return _backtracks; }
+
+private:
+	/// The state of a variable before it was narrowed, so that it can be restored when backtracking, along with the reason it was narrowed
+	struct TrailEntry
+	{
+		int variable;
+		GlyphSet domain;
+		int cause; ///< The variable whose domain caused the narrowing, or \c -1 if it was an assignment
+		int depth; ///< The depth of the assignment during which the narrowing happened
+	};
+
+	const Problem* problem;
+	std::vector<GlyphSet> domains;
+	std::vector<int> order; ///< The variable assigned at each depth
+
+	std::vector<TrailEntry> trail;
+	std::vector<std::size_t> trail_marks;   ///< For each depth, the size of \c trail before its assignment
+	std::vector<GlyphSet> untried;          ///< For each depth, the glyphs of its variable not yet tried
+	std::vector<std::vector<int>> conflicts; ///< For each depth, the earlier depths whose assignments caused a dead end below it
+
+	std::vector<int> queue;
+	std::vector<char> in_queue;
+	std::vector<char> marked;
+
+	bool _exhausted = false;
+	int _backtracks = 0;
+
+	std::optional<std::vector<int>> assign(int depth, std::size_t glyph);
+	void narrow(int variable, const GlyphSet& domain, int cause, int depth);
+	std::vector<int> explain(int variable, std::size_t trail_end);
+	void undo(int depth);
+};
+
+/// The schedules of cutoffs which solve_with_restarts() shares its runs between
+enum class RestartSchedule
+{
+	geometric, ///< \c FIRST_RUN_BACKTRACKS for the first run, doubling for each run after, which suits a search that needs a long run to get anywhere
+	luby,      ///< \c FIRST_RUN_BACKTRACKS times 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, ..., which is within a log factor of the best fixed cutoff for any search, see Luby et al. (1993)
+};
+
+/// What solve_with_restarts() did
+struct RestartStatistics
+{
+	int runs = 0;
+	std::optional<RestartSchedule> winner; ///< The schedule of the run which found the solution, if any
+};
+
+/** Search with Backtracker::solve() from \c domains, cutting each run off after a number of backtracks and starting over with a new random order.
+ *
+ * An unlucky early choice can leave a dead end which is only found much deeper, such as when the last rows have to meet the first rows across a wrapped edge,
+ * so starting over is often quicker than backtracking out of it. How long to let each run go depends on the selection, so the runs are shared between
+ * the \c RestartSchedule kinds, each run going to whichever schedule has made the fewest backtracks so far. The geometric schedule keeps the search complete.
+ *
+ * \param progress Called periodically with the number of backtracks so far, over all of the runs
+ * \param statistics Filled in with the number of runs and which schedule won, unless it is \c nullptr
+ * \return As Backtracker::solve(), giving up once \c max_backtracks have been made over all of the runs, or once a run shows that there is no solution
+ */
+std::optional<std::vector<std::size_t>> solve_with_restarts(const Problem& problem, const std::vector<GlyphSet>& domains, Rng& rng, int max_backtracks, const Backtracker::Progress& progress = {}, std::stop_token stop = {}, RestartStatistics* statistics = nullptr);
+
+/* Backtracker */
+/** \fn Backtracker::solve(Rng& rng, int max_backtracks, const Progress& progress, std::stop_token stop, Deadline deadline)
+ * Search for a value for every variable, trying the glyphs of each variable in a random order so that repeated calls give different knots.
+ * Each glyph is drawn by Problem::choose(), so glyphs with more weight tend to be tried first.
+ *
+ * \param rng The random engine used to order the glyphs
+ * \param max_backtracks The number of dead ends after which to give up
+ * \param progress Called periodically with the number of backtracks so far, to report on long searches
+ * \param stop Checked at every dead end, giving up as if out of backtracks once it is requested
+ * \param deadline Checked before every assignment, giving up as if out of backtracks once it has passed
+ * \return The glyph of each variable, to be passed to Problem::solution(), or \c std::nullopt if the search ran out of backtracks, was stopped, or exhausted every possibility.
+ *	In the second case, Backtracker::exhausted() is \c true, and the \c Problem has no solution.
+ */
+/** \fn Backtracker::assign(int depth, std::size_t glyph)
+ * Assign \c glyph to the variable at \c depth, and propagate the consequences.
+ *
+ * \return \c std::nullopt if this succeeded, otherwise the depths which together explain the emptied domain
+ */
+/** \fn Backtracker::explain(int variable, std::size_t trail_end)
+ * Find the depths whose assignments explain every glyph removed from \c variable by the first \c trail_end narrowings on the trail.
+ *
+ * Walking the trail backwards, each narrowing of a variable of interest makes its cause a variable of interest too, from that point back,
+ * until the assignments at the roots are reached. This may blame more depths than strictly necessary, but never fewer.
+ *
+ * \return The depths, sorted in ascending order
+ */
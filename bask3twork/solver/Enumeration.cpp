@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "solver/Enumeration.h"
+#include "solver/Problem.h"
+#include "solver/Propagation.h"
+#include "solver/StripSampler.h"
+
+namespace
+{
+	/// Lists every solution below \c state, which has already been propagated, branching on the variable with the fewest glyphs left.
+	/// \return \c false once the search should end early, because \c visit returned \c false or \c interrupted returned \c true
+	bool descend(const Propagator& state, std::vector<std::size_t>& values, const SolutionVisitor& visit, const std::function<bool()>& interrupted)
+	{
+		if (interrupted())
+			return false;
+
+		const std::vector<GlyphSet>& domains = state.domains();
+		int branch = -1;
+		for (int variable = 0; variable < (int)domains.size(); ++variable)
+			if (domains[variable].count() > 1 && (branch == -1 || domains[variable].count() < domains[branch].count()))
+				branch = variable;
+
+		if (branch == -1)
+		{
+			for (std::size_t variable = 0; variable < domains.size(); ++variable)
+				values[variable] = domains[variable].nth(0);
+			return visit(values);
+		}
+
+		const GlyphSet& domain = domains[branch];
+		for (std::size_t n = 0; n < domain.count(); ++n)
+		{
+			Propagator next = state;
+			if (next.assign(branch, domain.nth(n)) && !descend(next, values, visit, interrupted))
+				return false;
+		}
+		return true;
+	}
+
+	bool enumerate(const Problem& problem, const std::vector<GlyphSet>& domains, const SolutionVisitor& visit, const std::function<bool()>& interrupted)
+	{
+		Propagator initial(problem, domains);
+		if (!initial.propagate())
+			return true;
+
+		std::vector<std::size_t> values(domains.size());
+		return descend(initial, values, visit, interrupted);
+	}
+}
+
+bool for_each_solution(const Problem& problem, const std::vector<GlyphSet>& domains, const SolutionVisitor& visit, std::stop_token stop)
+{
+	return enumerate(problem, domains, visit, [&] { return stop.stop_requested(); });
+}
+
+SolutionCount count_solutions(const Problem& problem, const std::vector<GlyphSet>& domains, std::chrono::steady_clock::duration budget, std::stop_token stop)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	/// First, propagate, which shows that there are no solutions at all for most impossible selections.
+	Propagator initial(problem, domains);
+	if (!initial.propagate())
+		return { true, -std::numeric_limits<double>::infinity(), std::chrono::steady_clock::now() - start };
+
+	/// Then count by the transfer matrix, which only works if the selection is narrow enough, and give up if even that runs out of time.
+	const auto deadline = start + budget;
+	StripSampler sampler(problem, initial.domains());
+	if (sampler.count({}, stop, deadline))
+		return { true, sampler.log10_solutions(), std::chrono::steady_clock::now() - start };
+
+	/// Otherwise, list the solutions one at a time, checking the time at every step of the search so that a long run of dead ends still stops on time.
+	double solutions = 0.0;
+	const bool complete = enumerate(problem, initial.domains(),
+		[&](const std::vector<std::size_t>&)
+		{
+			solutions += 1.0;
+			return true;
+		},
+		[&] { return stop.stop_requested() || std::chrono::steady_clock::now() > deadline; });
+
+	return { complete, std::log10(solutions), std::chrono::steady_clock::now() - start };
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <stop_token>
+#include <vector>
+#include "Forward.h"
+#include "pure/GlyphSet.h"
+
+/// How many solutions a \c Problem has, as found by count_solutions()
+struct SolutionCount
+{
+	bool complete;                         ///< Whether every solution was counted, rather than only those listed before the time ran out or stopping was requested
+	double log10_solutions;                ///< The base ten logarithm of the number of solutions counted, which is minus infinity if there are none
+	std::chrono::duration<double> elapsed; ///< How long counting took
+};
+
+/// Called with the glyph of each variable for one solution, returning whether to go on to the next
+using SolutionVisitor = std::function<bool(const std::vector<std::size_t>& values)>;
+
+/** List every solution of a \c Problem, one at a time, by a depth-first search which maintains arc consistency as in \c Propagator.
+ *
+ * Only one \c Propagator per level of the search is kept at once, so memory stays proportional to the square of the number of variables however many solutions there are.
+ * Propagation cuts off most dead ends before they are reached, but the time taken still grows with the number of solutions, so this is only practical for tiny selections.
+ *
+ * \param domains The domains to start from, usually those of a \c Propagator after Propagator::propagate() has succeeded
+ * \return Whether every solution was listed, which is not the case if \c visit returned \c false or \c stop was requested
+ */
+bool for_each_solution(const Problem& problem, const std::vector<GlyphSet>& domains, const SolutionVisitor& visit, std::stop_token stop = {});
+
+/** Count the solutions of a \c Problem, for judging how hard a selection and its locked tiles are to generate.
+ *
+ * A strip narrow enough for a \c StripSampler is counted exactly by its transfer matrix, however many solutions it has.
+ * Anything else has its solutions listed with for_each_solution(), until there are no more.
+ * Either way, counting gives up once \c budget runs out or \c stop is requested.
+ *
+ * \param domains The domains to start from, usually those of a \c Propagator after Propagator::propagate() has succeeded
+ */
+SolutionCount count_solutions(const Problem& problem, const std::vector<GlyphSet>& domains, std::chrono::steady_clock::duration budget, std::stop_token stop = {});
@@ -0,0 +1,102 @@
+#include "pch.h"
+#include "pure/Random.h"
+#include "solver/Backtracking.h"
+#include "solver/Feasibility.h"
+#include "solver/Propagation.h"
+#include "Constants.h"
+
+namespace
+{
+	/// Finds a minimal conflicting subset of the requirements of a \c Problem, following the QuickXplain algorithm of Junker (2004).
+	class ConflictFinder
+	{
+	public:
+		ConflictFinder(const Problem& problem, std::stop_token stop) : problem(problem), stop(stop) {}
+
+		/// Whether the requirements with the given indices cannot all hold, as shown by propagation or an exhausted search, or can, as shown by a knot.
+		/// A search cut off before either is \c unknown, and is remembered, since the conflict can then no longer be shown to be minimal.
+		Feasibility check(const std::vector<int>& requirements)
+		{
+			Propagator propagator(problem, problem.domains_with(requirements));
+			if (!propagator.propagate())
+				return Feasibility::unsatisfiable;
+
+			Backtracker backtracker(problem, propagator.domains());
+			if (backtracker.solve(rng, FEASIBILITY_BACKTRACKS, {}, stop, std::chrono::steady_clock::now() + FEASIBILITY_TIME_BUDGET))
+				return Feasibility::satisfiable;
+			if (backtracker.exhausted())
+				return Feasibility::unsatisfiable;
+			_conclusive = false;
+			return Feasibility::unknown;
+		}
+
+		/// Whether every check so far was settled either way
+		bool conclusive() const { return _conclusive; }
+
+		/// Given that \c background together with \c candidates is refuted, the fewest of \c candidates it can find which are refuted together with \c background.
+		/// A check which is \c unknown is taken as not refuted, which keeps candidates that might have been left out, so the result still conflicts, but may not be minimal.
+		/// \param changed Whether \c background has grown since it was last checked on its own
+		std::vector<int> explain(const std::vector<int>& background, bool changed, std::span<const int> candidates)
+		{
+			if (stop.stop_requested())
+				return {};
+			if (changed && check(background) == Feasibility::unsatisfiable)
+				return {};
+			if (candidates.size() == 1)
+				return { candidates.front() };
+
+			const std::span<const int> first = candidates.first(candidates.size() / 2);
+			const std::span<const int> second = candidates.subspan(candidates.size() / 2);
+
+			std::vector<int> with_first = background;
+			with_first.insert(with_first.end(), first.begin(), first.end());
+			const std::vector<int> from_second = explain(with_first, true, second);
+
+			std::vector<int> with_second = background;
+			with_second.insert(with_second.end(), from_second.begin(), from_second.end());
+			std::vector<int> conflict = explain(with_second, !from_second.empty(), first);
+
+			conflict.insert(conflict.end(), from_second.begin(), from_second.end());
+			return conflict;
+		}
+
+	private:
+		const Problem& problem;
+		std::stop_token stop;
+		Rng rng{ 0 }; ///< Seeded the same way every time, so that the same selection always reports the same conflict
+		bool _conclusive = true;
+	};
+}
+
+FeasibilityReport check_feasibility(const Problem& problem, std::stop_token stop)
+{
+	ConflictFinder finder(problem, stop);
+
+	/// First, try to show that the \c Problem is satisfiable, giving up if that takes too many backtracks or too long.
+	std::vector<int> every_requirement(problem.requirements.size());
+	std::iota(every_requirement.begin(), every_requirement.end(), 0);
+
+	Propagator propagator(problem);
+	if (propagator.propagate())
+	{
+		Rng rng{ 0 };
+		Backtracker backtracker(problem, propagator.domains());
+		if (backtracker.solve(rng, FEASIBILITY_BACKTRACKS, {}, stop, std::chrono::steady_clock::now() + FEASIBILITY_TIME_BUDGET))
+			return { Feasibility::satisfiable };
+		if (!backtracker.exhausted())
+			return { Feasibility::unknown };
+	}
+
+	/// If it is unsatisfiable, check whether it is so even without any requirements, and otherwise narrow them down to a minimal conflict.
+	if (finder.check({}) == Feasibility::unsatisfiable)
+		return { Feasibility::unsatisfiable };
+
+	/// A conflict narrowed down only part of the way is not minimal, nor necessarily a conflict at all, so if stopped meanwhile, report nothing.
+	FeasibilityReport report = { Feasibility::unsatisfiable };
+	for (const int index : finder.explain({}, false, every_requirement))
+		report.conflict.push_back(problem.requirements[index]);
+	if (stop.stop_requested())
+		return { Feasibility::unknown };
+	report.minimal = finder.conclusive();
+	return report;
+}
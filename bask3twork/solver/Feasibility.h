@@ -0,0 +1,31 @@
+#pragma once
+#include <stop_token>
+#include <vector>
+#include "Forward.h"
+#include "solver/Problem.h"
+
+enum class Feasibility
+{
+	satisfiable,   ///< A knot was found
+	unsatisfiable, ///< No knot exists
+	unknown,       ///< Neither could be shown within \c FEASIBILITY_BACKTRACKS backtracks and \c FEASIBILITY_TIME_BUDGET, or the check was stopped
+};
+
+struct FeasibilityReport
+{
+	Feasibility feasibility;
+	std::vector<ProblemRequirement> conflict = {}; ///< When unsatisfiable, requirements which cannot all hold together, none of which can be left out if \c minimal
+	bool minimal = true; ///< Whether every search made while narrowing down \c conflict was settled, rather than cut off, so that it is shown to be minimal
+};
+
+/** Decide quickly whether a \c Problem has any solution, and if not, why not.
+ *
+ * Propagation alone refutes most impossible selections, and otherwise a short backtracking search either finds a knot or exhausts every possibility.
+ * An unsatisfiable \c Problem is then narrowed down to a minimal conflict, by leaving out halves of its requirements at a time and checking whether the rest still conflict.
+ * The conflict is empty if the selection is impossible on its own, such as when its size or wrapping can never have the symmetry.
+ * If one of those checks is cut off, the requirements it left out are kept, so the conflict still holds, but is reported as not minimal.
+ *
+ * Every search made is cut off after \c FEASIBILITY_TIME_BUDGET, so a large selection which is neither quickly solved nor quickly refuted is reported as unknown within milliseconds.
+ * Narrowing down a conflict can take many such searches, so this is meant to run on the generating thread, and gives up as unknown once \c stop is requested.
+ */
+FeasibilityReport check_feasibility(const Problem& problem, std::stop_token stop = {});
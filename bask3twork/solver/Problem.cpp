@@ -0,0 +1,311 @@
+#include "pch.h"
+#include "pure/ConnectionMask.h"
+#include "pure/Glyph.h"
+#include "pure/GlyphGrid.h"
+#include "pure/GlyphWeights.h"
+#include "pure/GridSize.h"
+#include "pure/Random.h"
+#include "pure/SelectionIterator.h"
+#include "pure/Symmetry.h"
+#include "solver/Problem.h"
+
+namespace
+{
+	class TransformedIndex
+	{
+	public:
+		TransformedIndex()
+		{
+			for (std::size_t t = 0; t < TransformCount; ++t)
+			{
+				const Transform transform = static_cast<Transform>(t);
+				for (std::size_t index = 0; index < AllGlyphs.size(); ++index)
+				{
+					const Glyph* glyph = transformed(index, transform);
+					on_side[t][side(Movement::up)][index] = glyph->up;
+					on_side[t][side(Movement::down)][index] = glyph->down;
+					on_side[t][side(Movement::left)][index] = glyph->left;
+					on_side[t][side(Movement::right)][index] = glyph->right;
+
+					if (glyph == &AllGlyphs[index])
+						invariant[t].insert(index);
+				}
+
+				// The bytes past the last glyph are left as DO_NOT_CARE, so each set is cut back to the glyphs
+				const GlyphSet all = GlyphSet::first(AllGlyphs.size());
+				for (std::size_t s = 0; s < 4; ++s)
+					for (std::size_t c = 0; c < ConnectionCount; ++c)
+						with[t][s][c] = glyphs_matching(on_side[t][s], static_cast<Connection>(c)) & all;
+			}
+		}
+
+		static std::size_t side(Movement movement) { return static_cast<std::size_t>(movement); }
+		static std::size_t connection(Connection connection) { return static_cast<std::size_t>(connection); }
+
+		std::array<std::array<std::array<GlyphSet, ConnectionCount>, 4>, TransformCount> with;
+		std::array<GlyphSet, TransformCount> invariant;
+		std::array<std::array<ConnectionBytes, 4>, TransformCount> on_side = {}; ///< For each transform and side, the connection of every glyph, as one array of bytes
+	};
+
+	const TransformedIndex& transformed_index()
+	{
+		static const TransformedIndex index;
+		return index;
+	}
+
+	constexpr Movement opposite(Movement side)
+	{
+		switch (side)
+		{
+		case Movement::up:    return Movement::down;
+		case Movement::down:  return Movement::up;
+		case Movement::left:  return Movement::right;
+		case Movement::right: return Movement::left;
+		}
+		throw;
+	}
+
+	constexpr Connection Connections::* member(Movement side)
+	{
+		switch (side)
+		{
+		case Movement::up:    return &Connections::up;
+		case Movement::down:  return &Connections::down;
+		case Movement::left:  return &Connections::left;
+		case Movement::right: return &Connections::right;
+		}
+		throw;
+	}
+}
+
+const GlyphSet& glyphs_with(Transform transform, Movement side, Connection connection)
+{
+	const TransformedIndex& index = transformed_index();
+	return index.with[static_cast<std::size_t>(transform)][TransformedIndex::side(side)][TransformedIndex::connection(connection)];
+}
+
+const GlyphSet& glyphs_invariant_under(Transform transform)
+{
+	return transformed_index().invariant[static_cast<std::size_t>(transform)];
+}
+
+GlyphSet supported_by(const ProblemEdge& edge, int variable, const GlyphSet& domain)
+/// The partners are found a connection at a time: the glyphs in \c domain are grouped by the connection on their side of the edge,
+/// and any connection with a nonempty group supports every glyph with the same connection on the other side.
+{
+	const bool from_a = edge.a == variable;
+	const Transform from_transform = from_a ? edge.transform_a : edge.transform_b;
+	const Movement from_side = from_a ? edge.side_a : edge.side_b;
+	const Transform to_transform = from_a ? edge.transform_b : edge.transform_a;
+	const Movement to_side = from_a ? edge.side_b : edge.side_a;
+
+	GlyphSet supported;
+	for (std::size_t c = 0; c < ConnectionCount; ++c)
+	{
+		const Connection connection = static_cast<Connection>(c);
+		if (connection == Connection::DO_NOT_CARE)
+			continue;
+		if ((domain & glyphs_with(from_transform, from_side, connection)).empty())
+			continue;
+		supported |= glyphs_with(to_transform, to_side, connection);
+	}
+	return supported;
+}
+
+Connection connection_of(std::size_t glyph, Transform transform, Movement side)
+/// This reads a table of bytes rather than the \c Glyph itself, since it is called for every glyph a local repair tries.
+{
+	return transformed_index().on_side[static_cast<std::size_t>(transform)][TransformedIndex::side(side)][glyph];
+}
+
+bool satisfied(const ProblemEdge& edge, std::size_t glyph_a, std::size_t glyph_b)
+{
+	return connection_of(glyph_a, edge.transform_a, edge.side_a) == connection_of(glyph_b, edge.transform_b, edge.side_b);
+}
+
+
+
+Problem::Problem(const Glyphs& base, Selection selection, Symmetry sym, bool wrap_x, bool wrap_y, const Pattern& pattern, const GlyphWeights* weights)
+	: selection(selection)
+	, cells(selection.rows() * selection.columns())
+	, weights(weights)
+{
+	const GridSize size = base.size();
+	const GlyphSet all = GlyphSet::first(AllGlyphs.size());
+
+	const auto cell_at = [&](Point p) -> ProblemCell& { return cells[(p.i - selection.min.i) * selection.columns() + (p.j - selection.min.j)]; };
+	const auto require = [&](RequirementSource source, Point point, Movement side, int variable, const GlyphSet& allowed) { requirements.push_back({ source, point, side, variable, allowed }); };
+
+	/// First, list the motions which map the knot onto itself, each a \c Transform about the centre of the selection followed by a shift.
+	/// These are the transforms of the symmetry, and for a repeating \c Pattern, a step of its period each way, mirrored for a glide.
+	struct Motion
+	{
+		Transform transform;
+		Point shift;
+	};
+	std::vector<Motion> motions;
+	for (const Transform transform : symmetry_group(sym))
+		motions.push_back({ transform, { 0, 0 } });
+
+	if (pattern.repeat != Repeat::none)
+	{
+		const Transform across = pattern.repeat == Repeat::glide_across ? Transform::mirror_x : Transform::identity;
+		const Transform down = pattern.repeat == Repeat::glide_down ? Transform::mirror_y : Transform::identity;
+		for (const int sign : { 1, -1 })
+		{
+			motions.push_back({ across, { 0, sign * pattern.period.columns } });
+			motions.push_back({ down, { sign * pattern.period.rows, 0 } });
+		}
+	}
+
+	/// Then, walk the selection in raster order, making each cell which is not already part of an orbit into a new variable,
+	/// along with every cell which a chain of motions reaches from it without leaving the selection.
+	std::vector<Point> orbit;
+	for (const Point p : SelectionRange(selection))
+	{
+		if (cell_at(p).variable != -1)
+			continue;
+
+		const int variable = (int)unrequired_domains.size();
+		GlyphSet& domain = unrequired_domains.emplace_back(all);
+
+		cell_at(p) = { p, variable, Transform::identity };
+		orbit.assign(1, p);
+		for (std::size_t next = 0; next < orbit.size(); ++next)
+		{
+			const ProblemCell from = cell_at(orbit[next]);
+			for (const Motion& motion : motions)
+			{
+				const Point image = apply(motion.transform, from.point, selection) + motion.shift;
+				if (!selection.contains(image))
+					continue;
+
+				/// If a cell is reached by two different transforms, the glyph must look the same under both of them.
+				const Transform transform = compose(from.transform, motion.transform);
+				ProblemCell& cell = cell_at(image);
+				if (cell.variable == -1)
+				{
+					cell = { image, variable, transform };
+					orbit.push_back(image);
+				}
+				else if (cell.transform != transform)
+					domain &= glyphs_invariant_under(compose(transform, inverse(cell.transform)));
+			}
+		}
+
+		/// If a cell is already fixed, the variable can only be that glyph, seen from the first cell.
+		for (const Point image : orbit)
+			if (const Glyph* fixed = base[image])
+			{
+				GlyphSet only;
+				only.insert(index_of(fixed->*GlyphsTransformed::member(inverse(cell_at(image).transform))));
+				require(RequirementSource::locked, image, Movement::up, variable, only);
+			}
+	}
+
+	/// Next, constrain each side of each cell by whatever is across that side.
+	const auto neighbour = [&](Point p, Movement side) -> std::optional<Point>
+		{
+			Point q = p + Point::movement(side);
+			if (q.i < 0 || q.i >= size.rows)
+			{
+				if (!wrap_y)
+					return std::nullopt;
+				q.i = (q.i + size.rows) % size.rows;
+			}
+			if (q.j < 0 || q.j >= size.columns)
+			{
+				if (!wrap_x)
+					return std::nullopt;
+				q.j = (q.j + size.columns) % size.columns;
+			}
+			return q;
+		};
+
+	std::set<std::tuple<int, Transform, Movement, int, Transform, Movement>> added;
+	for (const ProblemCell& cell : cells)
+	{
+		for (const Movement side : { Movement::up, Movement::down, Movement::left, Movement::right })
+		{
+			const std::optional<Point> q = neighbour(cell.point, side);
+
+			/// (a) Across the edge of the grid without wrapping, the side must be empty.
+			if (!q)
+			{
+				require(RequirementSource::grid_edge, cell.point, side, cell.variable, glyphs_with(cell.transform, side, Connection::EMPTY));
+				continue;
+			}
+
+			/// (b) Outside the selection, the side must match the fixed glyph, unless that cell is yet to be generated too.
+			if (!selection.contains(*q))
+			{
+				if (const Glyph* fixed = base[*q])
+				{
+					require(RequirementSource::neighbour, cell.point, side, cell.variable, glyphs_with(cell.transform, side, fixed->*member(opposite(side))));
+					loose_ends += strand_count(fixed->*member(opposite(side)));
+				}
+				else
+					enclosed = false;
+				continue;
+			}
+
+			/// (c) Inside the selection, each adjacency is added once, from the cell on its upper or left side.
+			if (side == Movement::up || side == Movement::left)
+				continue;
+
+			/// Each copy of a repeating pattern gives the same edges again, which are only added the first time.
+			const ProblemCell& other = cell_at(*q);
+			if (other.variable != cell.variable)
+			{
+				if (pattern.repeat == Repeat::none || added.insert({ cell.variable, cell.transform, side, other.variable, other.transform, opposite(side) }).second)
+					edges.push_back({ cell.variable, cell.transform, side, other.variable, other.transform, opposite(side) });
+				continue;
+			}
+
+			/// (d) If both cells belong to the same orbit, the requirement only involves one variable.
+			GlyphSet allowed;
+			all.for_each([&](std::size_t index)
+				{
+					if (transformed(index, cell.transform)->*member(side) == transformed(index, other.transform)->*member(opposite(side)))
+						allowed.insert(index);
+				});
+			unrequired_domains[cell.variable] &= allowed;
+		}
+	}
+
+	std::vector<int> every_requirement(requirements.size());
+	std::iota(every_requirement.begin(), every_requirement.end(), 0);
+	domains = domains_with(every_requirement);
+
+	edges_of.resize(domains.size());
+	for (int e = 0; e < (int)edges.size(); ++e)
+	{
+		edges_of[edges[e].a].push_back(e);
+		edges_of[edges[e].b].push_back(e);
+	}
+}
+
+std::vector<GlyphSet> Problem::domains_with(const std::vector<int>& requirement_indices) const
+{
+	std::vector<GlyphSet> result = unrequired_domains;
+	for (const int index : requirement_indices)
+		result[requirements[index].variable] &= requirements[index].allowed;
+	return result;
+}
+
+std::size_t Problem::choose(const GlyphSet& domain, Rng& rng) const
+{
+	return weights ? weights->choose(domain, rng) : domain.nth(rng.below(domain.count()));
+}
+
+Glyphs Problem::solution(Glyphs base, const std::vector<std::size_t>& values) const
+{
+	place(base, values);
+	return base;
+}
+
+void Problem::place(Glyphs& glyphs, const std::vector<std::size_t>& values) const
+{
+	for (const ProblemCell& cell : cells)
+		glyphs.set(cell.point, transformed(values[cell.variable], cell.transform));
+}
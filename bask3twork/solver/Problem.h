@@ -0,0 +1,111 @@
+#pragma once
+#include <vector>
+#include "Forward.h"
+#include "pure/CornerMovement.h"
+#include "pure/GlyphSet.h"
+#include "pure/Pattern.h"
+#include "pure/Selection.h"
+#include "pure/Transform.h"
+
+/// One cell of the selection, seen as an image of its orbit's variable
+struct ProblemCell
+{
+	Point point;
+	int variable = -1;   ///< The index of this cell's orbit in \c Problem::domains
+	Transform transform; ///< The glyph in this cell is the variable's glyph under this transform
+};
+
+/// A constraint between two variables, requiring that side \c side_a of variable \c a under \c transform_a
+/// has the same \c Connection as side \c side_b of variable \c b under \c transform_b
+struct ProblemEdge
+{
+	int a;
+	Transform transform_a;
+	Movement side_a;
+
+	int b;
+	Transform transform_b;
+	Movement side_b;
+};
+
+/// Where a \c ProblemRequirement comes from
+enum class RequirementSource
+{
+	locked,    ///< The glyph in the cell is fixed, either by locking it or by locking one of its symmetric images
+	grid_edge, ///< The side of the cell is on the edge of the grid without wrapping, so must be \c Connection::EMPTY
+	neighbour, ///< The side of the cell must match the fixed glyph across it, outside the selection
+};
+
+/// A requirement on one variable from a fixed glyph or from the boundary of the selection, which can be left out to look for the cause of a conflict
+struct ProblemRequirement
+{
+	RequirementSource source;
+	Point point;      ///< The cell the requirement applies to
+	Movement side;    ///< The side of the cell facing the boundary, unused for \c RequirementSource::locked
+	int variable;
+	GlyphSet allowed; ///< The glyphs of the variable which meet the requirement
+};
+
+/** The generation of one selection, posed as a constraint satisfaction problem.
+ *
+ * Each orbit of the symmetry within the selection becomes one variable, whose domain is a \c GlyphSet in the frame of the orbit's first cell in raster order.
+ * Every other cell in the orbit holds the same glyph under some \c Transform, so narrowing a variable narrows all of its symmetric images at once.
+ * A repeating \c Pattern joins the copies of each cell into the same orbit, so only the variables of one fundamental tile are ever searched.
+ *
+ * Everything which only involves one variable is folded into the initial domains: glyphs already fixed by locking, the \c Connection::EMPTY edges of the grid,
+ * the fixed glyphs around the selection, other than any which are still to be generated themselves, and the requirements of cells which lie on a mirror line or at the centre of a rotation.
+ * The first three are also kept as \c requirements, so that the domains can be rebuilt without some of them.
+ * The adjacencies between different variables, including those across a wrapped edge, become the edges.
+ */
+class Problem
+{
+public:
+	/// \param base The glyphs of the knot as made by Knot::make_base_glyphs(), where \c nullptr marks a cell to be generated
+	/// \param pattern How the knot repeats across the selection, on top of \c sym
+	/// \param weights How likely each glyph is to be chosen by the solvers, or \c nullptr for every glyph equally likely, which must outlive the \c Problem
+	Problem(const Glyphs& base, Selection selection, Symmetry sym, bool wrap_x, bool wrap_y, const Pattern& pattern = {}, const GlyphWeights* weights = nullptr);
+
+	Selection selection;
+	std::vector<GlyphSet> domains;          ///< The initial domain of each variable, numbered in the raster order of their first cells
+	std::vector<ProblemRequirement> requirements;
+	std::vector<ProblemCell> cells;         ///< Every cell of the selection, in raster order
+	std::vector<ProblemEdge> edges;
+	std::vector<std::vector<int>> edges_of; ///< The indices into \c edges of every edge touching each variable
+	const GlyphWeights* weights;
+
+	/// A random glyph from \c domain, which must not be empty, chosen in proportion to \c weights, or uniformly without them, see GlyphWeights::choose()
+	std::size_t choose(const GlyphSet& domain, Rng& rng) const;
+
+	/// The initial domain of each variable, meeting only the requirements with the given indices
+	std::vector<GlyphSet> domains_with(const std::vector<int>& requirement_indices) const;
+
+	/** Whether the selection is surrounded by fixed glyphs and grid edges, with an odd number of strands passing into it.
+	 * Every glyph has an even number of strand ends, so such a selection has no solution, though a search can take a very long time to show it.
+	 */
+	bool odd_strands() const { return enclosed && loose_ends % 2 != 0; }
+
+	/// Writes the glyph of every cell into \c base, given the value of each variable
+	Glyphs solution(Glyphs base, const std::vector<std::size_t>& values) const;
+	/// As Problem::solution(), but into existing storage, leaving every cell outside the selection untouched
+	void place(Glyphs& glyphs, const std::vector<std::size_t>& values) const;
+
+private:
+	std::vector<GlyphSet> unrequired_domains; ///< The domain of each variable before any of the \c requirements
+	bool enclosed = true;                     ///< Whether every neighbour outside the selection is a fixed glyph or an edge of the grid
+	int loose_ends = 0;                       ///< The number of strands passing into the selection from the fixed glyphs around it
+};
+
+/// The set of glyphs which have \c connection on side \c side, after being transformed by \c transform
+const GlyphSet& glyphs_with(Transform transform, Movement side, Connection connection);
+
+/// The set of glyphs which are unchanged by \c transform
+const GlyphSet& glyphs_invariant_under(Transform transform);
+
+/// The set of glyphs for the other end of \c edge which match at least one glyph in \c domain, taken at the end belonging to \c variable
+GlyphSet supported_by(const ProblemEdge& edge, int variable, const GlyphSet& domain);
+
+/// The \c Connection on side \c side of the glyph with index \c glyph, after being transformed by \c transform
+Connection connection_of(std::size_t glyph, Transform transform, Movement side);
+
+/// Whether \c edge holds when its variable \c a has the glyph \c glyph_a and its variable \c b has the glyph \c glyph_b
+bool satisfied(const ProblemEdge& edge, std::size_t glyph_a, std::size_t glyph_b);
@@ -0,0 +1,178 @@
+#include "pch.h"
+#include "pure/Glyph.h"
+#include "pure/GlyphGrid.h"
+#include "pure/Random.h"
+#include "solver/Problem.h"
+#include "solver/Propagation.h"
+
+Propagator::Propagator(const Problem& problem) : Propagator(problem, problem.domains) {}
+
+Propagator::Propagator(const Problem& problem, std::vector<GlyphSet> domains)
+	: problem(&problem)
+	, _domains(std::move(domains))
+	, in_queue(_domains.size(), false)
+{
+	queue.reserve(problem.domains.size());
+	for (int variable = 0; variable < (int)_domains.size(); ++variable)
+		enqueue(variable);
+}
+
+void Propagator::enqueue(int variable)
+{
+	if (in_queue[variable])
+		return;
+	in_queue[variable] = true;
+	queue.push_back(variable);
+}
+
+bool Propagator::revise(int edge, bool narrow_a)
+/// Removes every glyph from one end of \c edge which has no partner left at the other end.
+{
+	const ProblemEdge& e = problem->edges[edge];
+	const int self = narrow_a ? e.a : e.b;
+	const int other = narrow_a ? e.b : e.a;
+
+	const GlyphSet narrowed = _domains[self] & supported_by(e, other, _domains[other]);
+	if (narrowed == _domains[self])
+		return true;
+
+	_domains[self] = narrowed;
+	if (narrowed.empty())
+		return false;
+
+	fewest.decrease(self, (int)narrowed.count());
+
+	enqueue(self);
+	return true;
+}
+
+bool Propagator::propagate()
+{
+	while (!queue.empty())
+	{
+		const int variable = queue.back();
+		queue.pop_back();
+		in_queue[variable] = false;
+
+		for (const int edge : problem->edges_of[variable])
+		{
+			const bool narrow_a = problem->edges[edge].a != variable;
+			if (!revise(edge, narrow_a))
+				return false;
+		}
+	}
+	return true;
+}
+
+bool Propagator::assign(int variable, std::size_t glyph)
+{
+	GlyphSet only;
+	only.insert(glyph);
+	_domains[variable] &= only;
+	if (_domains[variable].empty())
+		return false;
+
+	enqueue(variable);
+	return propagate();
+}
+
+void Propagator::reserve()
+/// Makes room for every variable in the storage which grows while filling, since a copy of a propagator only has room for what its original held.
+/// Each variable is queued and chosen at most once at a time, so that filling and starting over make no allocations after this.
+{
+	queue.reserve(_domains.size());
+	choices.reserve(_domains.size());
+	frontier.reserve(_domains.size());
+}
+
+bool Propagator::fill_randomly(Rng& rng)
+{
+	reserve();
+	for (int variable = 0; variable < (int)_domains.size(); ++variable)
+	{
+		const GlyphSet& domain = _domains[variable];
+		if (domain.empty())
+			return false;
+		if (domain.count() == 1)
+			continue;
+
+		const std::size_t glyph = problem->choose(domain, rng);
+		choices.emplace_back(variable, glyph);
+		if (!assign(variable, glyph))
+		{
+			failed = variable;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Propagator::fill_fewest_first(Rng& rng)
+{
+	reserve();
+	fewest.build(_domains);
+	while (!fewest.empty())
+	{
+		const int variable = fewest.pop();
+		const GlyphSet& domain = _domains[variable];
+		if (domain.count() == 1)
+			continue;
+
+		const std::size_t glyph = problem->choose(domain, rng);
+		choices.emplace_back(variable, glyph);
+		if (!assign(variable, glyph))
+		{
+			failed = variable;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Propagator::restart_near_failure(const Propagator& initial, int radius)
+{
+	if (failed == -1)
+		return false;
+
+	/// First, walk out from the variable which failed along the edges, marking every variable within \c radius edges of it.
+	distances.assign(_domains.size(), -1);
+	frontier.clear();
+	distances[failed] = 0;
+	frontier.push_back(failed);
+	for (std::size_t next = 0; next < frontier.size(); ++next)
+	{
+		const int variable = frontier[next];
+		if (distances[variable] == radius)
+			continue;
+		for (const int edge : problem->edges_of[variable])
+		{
+			const int other = problem->edges[edge].a == variable ? problem->edges[edge].b : problem->edges[edge].a;
+			if (distances[other] != -1)
+				continue;
+			distances[other] = distances[variable] + 1;
+			frontier.push_back(other);
+		}
+	}
+
+	/// Then, go back to the initial domains, and give every unmarked variable its glyph again, all at once before propagating.
+	///	The storage of this propagator is kept, so that starting over makes no allocations.
+	_domains = initial._domains;
+	queue = initial.queue;
+	in_queue = initial.in_queue;
+	failed = -1;
+	std::erase_if(choices, [&](const std::pair<int, std::size_t>& choice) { return distances[choice.first] != -1; });
+	for (const auto& [variable, glyph] : choices)
+	{
+		GlyphSet only;
+		only.insert(glyph);
+		_domains[variable] &= only;
+		enqueue(variable);
+	}
+	return propagate();
+}
+
+void Propagator::place(Glyphs& glyphs) const
+{
+	for (const ProblemCell& cell : problem->cells)
+		glyphs.set(cell.point, transformed(_domains[cell.variable].nth(0), cell.transform));
+}
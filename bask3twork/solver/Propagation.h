@@ -0,0 +1,83 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "Forward.h"
+#include "pure/GlyphSet.h"
+#include "solver/VariableHeap.h"
+
+/** Arc consistency over the domains of a \c Problem.
+ *
+ * Each edge keeps, for both of its variables, only the glyphs which have at least one partner left in the other variable's domain.
+ * Narrowing one variable therefore prunes its neighbours, its neighbours across a wrapped edge, and through the orbit variables, all of its symmetric images.
+ * A domain becoming empty means that no knot can be made from the current state.
+ */
+class Propagator
+{
+public:
+	explicit Propagator(const Problem& problem);
+	Propagator(const Problem& problem, std::vector<GlyphSet> domains);
+
+	bool propagate();
+	bool assign(int variable, std::size_t glyph);
+	bool fill_randomly(Rng& rng);
+	bool fill_fewest_first(Rng& rng);
+	bool restart_near_failure(const Propagator& initial, int radius);
+
+	const std::vector<GlyphSet>& domains() const { return _domains; }
+	void place(Glyphs& glyphs) const;
+
+private:
+	const Problem* problem;
+	std::vector<GlyphSet> _domains;
+	std::vector<int> queue;     ///< The variables whose domains have shrunk, but whose edges have not been revised since
+	std::vector<char> in_queue;
+	VariableHeap fewest;        ///< The variables still to be assigned by Propagator::fill_fewest_first(), empty otherwise
+
+	std::vector<std::pair<int, std::size_t>> choices; ///< Each variable given a glyph by the fills since starting over, with its glyph, in the order they were given
+	int failed = -1;            ///< The variable whose glyph emptied a domain in the last fill, or \c -1 if it has not failed
+	std::vector<int> distances; ///< The number of edges from \c failed to each variable, used by Propagator::restart_near_failure()
+	std::vector<int> frontier;  ///< The variables reached from \c failed so far, used by Propagator::restart_near_failure()
+
+	bool revise(int edge, bool narrow_a);
+	void enqueue(int variable);
+	void reserve();
+};
+
+/* Propagator */
+/** \fn Propagator::propagate()
+ * Revise every edge touching a variable in the queue until nothing changes, starting with every variable on the first call.
+ *
+ * \return \c false if any domain became empty
+ */
+/** \fn Propagator::assign(int variable, std::size_t glyph)
+ * Narrow the domain of \c variable to the single glyph \c glyph, and propagate the consequences.
+ *
+ * \return \c false if any domain became empty
+ */
+/** \fn Propagator::fill_randomly(Rng& rng)
+ * Assign each variable in turn to a random glyph from its remaining domain, chosen by Problem::choose(), propagating after each one.
+ * A variable with only one glyph left already has it, so is skipped. This does not backtrack, so that it makes exactly one attempt at generating.
+ *
+ * \return \c false if any domain became empty, in which case the caller should start again from a fresh copy, or from Propagator::restart_near_failure()
+ */
+/** \fn Propagator::fill_fewest_first(Rng& rng)
+ * As Propagator::fill_randomly(), but always assigning the variable with the fewest glyphs left next, rather than going in raster order.
+ * Locked cells, and the cells narrowed by them or by a wrapped edge, are then assigned before the open parts of the selection.
+ * For single attempts, raster order usually succeeds more often, since it keeps the unassigned cells in one piece where arc consistency sees most of what they need,
+ * so this is an alternative to Propagator::fill_randomly() rather than a replacement.
+ *
+ * \return \c false if any domain became empty, in which case the caller should start again from a fresh copy, or from Propagator::restart_near_failure()
+ */
+/** \fn Propagator::restart_near_failure(const Propagator& initial, int radius)
+ * After a fill has failed, start over from the domains of \c initial, keeping the glyph given to every variable more than \c radius edges away from the one which failed,
+ * so that the same fill can then be called again to choose only the variables around the failure afresh.
+ * On a large selection, a dead end usually only involves the few cells around it, so this keeps most of the work of the attempt rather than throwing it all away.
+ * The kept glyphs all fitted together before the failure, so propagating them again never empties a domain.
+ *
+ * \param initial The propagator which this one was copied from before the fill, holding the propagated fixed glyphs and edges
+ * \return \c false if the last fill has not failed, so there is nothing to start over from
+ */
+/** \fn Propagator::place(Glyphs& glyphs)
+ * Write the single glyph left in each domain into every cell of its orbit, after Propagator::fill_randomly() or Propagator::fill_fewest_first() has succeeded.
+ * This is the same as Problem::solution(), but into existing storage rather than a new copy.
+ */
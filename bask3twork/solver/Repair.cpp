@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "pure/Random.h"
+#include "solver/Problem.h"
+#include "solver/Repair.h"
+#include "Constants.h"
+
+Repairer::Repairer(const Problem& problem, std::vector<GlyphSet> domains)
+	: problem(&problem)
+	, domains(std::move(domains))
+	, values(this->domains.size())
+	, conflicts_of(this->domains.size(), 0)
+	, positions(this->domains.size(), -1)
+{
+	conflicted.reserve(this->domains.size());
+}
+
+namespace
+{
+	/** A count for every glyph at once, held as bit planes, so that plane \c k holds the glyphs whose count has bit \c k set.
+	 * Adding a set to the counts ripples a carry up through the planes, a few word operations for every glyph together, rather than a step for each glyph.
+	 */
+	class GlyphCounts
+	{
+	public:
+		void add(GlyphSet set)
+		{
+			for (std::size_t plane = 0; !set.empty(); ++plane)
+			{
+				const GlyphSet carry = planes[plane] & set;
+				planes[plane] ^= set;
+				set = carry;
+				used = std::max(used, plane + 1);
+			}
+		}
+
+		/// The glyphs of \c among with the highest count, found by keeping those with each bit set, from the highest bit down, wherever any of them has it
+		GlyphSet highest(GlyphSet among) const
+		{
+			for (std::size_t plane = used; plane-- > 0;)
+			{
+				const GlyphSet with_bit = among & planes[plane];
+				if (!with_bit.empty())
+					among = with_bit;
+			}
+			return among;
+		}
+
+	private:
+		std::array<GlyphSet, 16> planes; ///< Enough for far more edges than any variable has
+		std::size_t used = 0;
+	};
+}
+
+std::size_t Repairer::best_value(int variable, int assigned, Rng& rng) const
+/** The glyph in the domain of \c variable which breaks the fewest edges with the variables numbered below \c assigned, picking among ties by Problem::choose().
+ *
+ * Each edge is met by exactly the glyphs which have the connection of the glyph at its other end, which is one set from glyphs_with(),
+ * so the glyphs which break the fewest edges are those found in the most of those sets.
+ */
+{
+	GlyphCounts met;
+	for (const int e : problem->edges_of[variable])
+	{
+		const ProblemEdge& edge = problem->edges[e];
+		const bool from_a = edge.a == variable;
+		const int other = from_a ? edge.b : edge.a;
+		if (other >= assigned)
+			continue;
+
+		const Connection connection = from_a
+			? connection_of(values[other], edge.transform_b, edge.side_b)
+			: connection_of(values[other], edge.transform_a, edge.side_a);
+		met.add(from_a
+			? glyphs_with(edge.transform_a, edge.side_a, connection)
+			: glyphs_with(edge.transform_b, edge.side_b, connection));
+	}
+	return problem->choose(met.highest(domains[variable]), rng);
+}
+
+void Repairer::add_conflicts(int variable, int count)
+/// Changes the number of broken edges touching \c variable by \c count, adding it to or removing it from \c conflicted as needed.
+{
+	conflicts_of[variable] += count;
+	if (conflicts_of[variable] > 0 && positions[variable] == -1)
+	{
+		positions[variable] = (int)conflicted.size();
+		conflicted.push_back(variable);
+	}
+	else if (conflicts_of[variable] == 0 && positions[variable] != -1)
+	{
+		const int last = conflicted.back();
+		conflicted[positions[variable]] = last;
+		positions[last] = positions[variable];
+		conflicted.pop_back();
+		positions[variable] = -1;
+	}
+}
+
+void Repairer::change(int variable, std::size_t value)
+/// Gives \c variable the glyph \c value, updating the count of broken edges for it and for every variable it shares an edge with.
+{
+	for (const int e : problem->edges_of[variable])
+	{
+		const ProblemEdge& edge = problem->edges[e];
+		const bool was = satisfied(edge, values[edge.a], values[edge.b]);
+		const bool now = edge.a == variable ? satisfied(edge, value, values[edge.b]) : satisfied(edge, values[edge.a], value);
+		if (was == now)
+			continue;
+
+		const int difference = now ? -1 : 1;
+		add_conflicts(edge.a, difference);
+		add_conflicts(edge.b, difference);
+		conflicts += difference;
+	}
+	values[variable] = value;
+}
+
+std::optional<std::vector<std::size_t>> Repairer::solve(Rng& rng, std::chrono::steady_clock::duration budget, const Progress& progress, std::stop_token stop)
+{
+	const auto deadline = std::chrono::steady_clock::now() + budget;
+	const int count = (int)values.size();
+
+	/// \b (1) Give each variable in turn the glyph which breaks the fewest edges with the variables before it, then count the edges which are still broken.
+	for (int variable = 0; variable < count; ++variable)
+	{
+		if (domains[variable].empty())
+			return std::nullopt;
+		values[variable] = best_value(variable, variable, rng);
+	}
+	for (const ProblemEdge& edge : problem->edges)
+	{
+		if (satisfied(edge, values[edge.a], values[edge.b]))
+			continue;
+		add_conflicts(edge.a, 1);
+		add_conflicts(edge.b, 1);
+		++conflicts;
+	}
+
+	/// \b (2) While any edge is broken, pick a variable with a broken edge at random, and give it the glyph which breaks the fewest of its edges,
+	///	or once in \c REPAIR_WALK_ONE_IN repairs, any glyph from its domain. Give up when the time runs out or \c stop is requested.
+	while (conflicts > 0)
+	{
+		if (stop.stop_requested() || std::chrono::steady_clock::now() > deadline)
+			return std::nullopt;
+		if (progress && _repairs % ATTEMPTS_DISPLAY_INCREMENT == 0)
+			progress(conflicts);
+
+		const int variable = conflicted[rng.below(conflicted.size())];
+		const GlyphSet& domain = domains[variable];
+		const std::size_t value = rng.below(REPAIR_WALK_ONE_IN) == 0
+			? problem->choose(domain, rng)
+			: best_value(variable, count, rng);
+		change(variable, value);
+		++_repairs;
+	}
+
+	/// \b (3) Once no edge is broken, every variable's glyph is a solution.
+	return values;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <vector>
+#include "Forward.h"
+#include "pure/GlyphSet.h"
+
+/** A local search over the variables of a \c Problem, which repairs a complete but inconsistent assignment rather than starting over.
+ *
+ * Every variable always holds some glyph from its domain, so the glyphs fixed by locking and the edges of the grid are always met,
+ * and only the edges between variables can be broken. The variables are first given glyphs in raster order, each matching as many of the earlier ones as it can.
+ * Then a variable with a broken edge is picked at random and given the glyph which breaks the fewest of its edges, following the min-conflicts heuristic of Minton et al. (1992).
+ * Since each variable is a whole orbit, changing it changes all of its symmetric images at once.
+ * Once in a while, a glyph is picked at random by Problem::choose() instead, so that the search can walk off a plateau where no single change helps.
+ */
+class Repairer
+{
+public:
+	/// \param domains The domains to pick glyphs from, usually those of a \c Propagator after Propagator::propagate() has succeeded
+	Repairer(const Problem& problem, std::vector<GlyphSet> domains);
+
+	/// Called with the number of broken edges left, every \c ATTEMPTS_DISPLAY_INCREMENT repairs
+	using Progress = std::function<void(int conflicts)>;
+
+	std::optional<std::vector<std::size_t>> solve(Rng& rng, std::chrono::steady_clock::duration budget, const Progress& progress = {}, std::stop_token stop = {});
+
+	int repairs() const { return _repairs; }
+
+private:
+	const Problem* problem;
+	std::vector<GlyphSet> domains;
+	std::vector<std::size_t> values;
+
+	std::vector<int> conflicts_of; ///< The number of broken edges touching each variable
+	std::vector<int> conflicted;   ///< Every variable with a broken edge, in no particular order
+	std::vector<int> positions;    ///< The position of each variable in \c conflicted, or \c -1 if it has no broken edges
+	int conflicts = 0;             ///< The number of broken edges
+	int _repairs = 0;
+
+	std::size_t best_value(int variable, int assigned, Rng& rng) const;
+	void change(int variable, std::size_t value);
+	void add_conflicts(int variable, int count);
+};
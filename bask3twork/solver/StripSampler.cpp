@@ -0,0 +1,198 @@
+#include "pch.h"
+#include "pure/GlyphSet.h"
+#include "pure/Random.h"
+#include "solver/Problem.h"
+#include "solver/StripSampler.h"
+#include "Constants.h"
+
+namespace
+{
+	/// Each open edge takes four bits of a boundary, which is enough for every \c Connection
+	constexpr int SLOT_BITS = 4;
+	constexpr int MAX_SLOTS = 64 / SLOT_BITS;
+	constexpr std::uint64_t SLOT_MASK = (1 << SLOT_BITS) - 1;
+
+	constexpr std::uint64_t slot_value(Connection connection, int slot) { return static_cast<std::uint64_t>(connection) << (SLOT_BITS * slot); }
+}
+
+StripSampler::StripSampler(const Problem& problem, const std::vector<GlyphSet>& domains)
+{
+	const int count = (int)domains.size();
+
+	/// First, order the variables by their first cells, along the longer side of the selection, so that as few edges as possible are open at once.
+	std::vector<Point> first(count, { -1, -1 });
+	for (const ProblemCell& cell : problem.cells)
+		if (first[cell.variable].i == -1)
+			first[cell.variable] = cell.point;
+
+	const bool by_columns = problem.selection.columns() > problem.selection.rows();
+	std::vector<int> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::ranges::stable_sort(order, {}, [&](int variable) { return by_columns ? std::pair(first[variable].j, first[variable].i) : std::pair(first[variable].i, first[variable].j); });
+
+	std::vector<int> position(count);
+	for (int k = 0; k < count; ++k)
+		position[order[k]] = k;
+
+	/// Then, for each step, work out which edges it closes, which stay open, and which it opens, and give each of them a slot in the boundaries before and after it.
+	std::vector<int> open;
+	steps.reserve(count);
+	for (int k = 0; k < count && !too_wide; ++k)
+	{
+		Step& step = steps.emplace_back();
+		step.variable = order[k];
+
+		/// Each edge to this variable is either closed here, if the other end came earlier, or opened here, if it comes later.
+		struct Side
+		{
+			int slot;
+			Transform transform;
+			Movement side;
+		};
+		std::vector<Side> closing;
+		std::vector<Side> opening;
+		std::vector<int> next_open;
+		for (int slot = 0; slot < (int)open.size(); ++slot)
+		{
+			const ProblemEdge& edge = problem.edges[open[slot]];
+			if (edge.a == step.variable)
+				closing.push_back({ slot, edge.transform_a, edge.side_a });
+			else if (edge.b == step.variable)
+				closing.push_back({ slot, edge.transform_b, edge.side_b });
+			else
+			{
+				step.carried.emplace_back(slot, (int)next_open.size());
+				next_open.push_back(open[slot]);
+			}
+		}
+		for (const int e : problem.edges_of[step.variable])
+		{
+			const ProblemEdge& edge = problem.edges[e];
+			const bool from_a = edge.a == step.variable;
+			if (position[from_a ? edge.b : edge.a] <= k)
+				continue;
+			opening.push_back({ (int)next_open.size(), from_a ? edge.transform_a : edge.transform_b, from_a ? edge.side_a : edge.side_b });
+			next_open.push_back(e);
+		}
+
+		if ((int)next_open.size() > MAX_SLOTS)
+			too_wide = true;
+		open = std::move(next_open);
+
+		for (const Side& side : closing)
+			step.closing_mask |= SLOT_MASK << (SLOT_BITS * side.slot);
+
+		domains[step.variable].for_each([&](std::size_t glyph)
+			{
+				Choice& choice = step.choices.emplace_back(Choice{ 0, 0, glyph });
+				for (const Side& side : closing)
+					choice.required |= slot_value(connection_of(glyph, side.transform, side.side), side.slot);
+				for (const Side& side : opening)
+					choice.opened |= slot_value(connection_of(glyph, side.transform, side.side), side.slot);
+			});
+		std::ranges::sort(step.choices, {}, &Choice::required);
+	}
+}
+
+std::uint64_t StripSampler::carry(const Step& step, std::uint64_t boundary) const
+{
+	std::uint64_t carried = 0;
+	for (const auto& [from, to] : step.carried)
+		carried |= ((boundary >> (SLOT_BITS * from)) & SLOT_MASK) << (SLOT_BITS * to);
+	return carried;
+}
+
+bool StripSampler::count(const Progress& progress, std::stop_token stop, Deadline deadline)
+{
+	if (too_wide)
+		return false;
+
+	const int total = (int)steps.size();
+	completions.assign(total + 1, {});
+	completions[0].emplace(0, 0.0);
+	log10_scale = 0.0;
+
+	/// Go forwards through the steps, collecting the boundaries each one can reach, giving up if there are too many to count.
+	for (int k = 0; k < total; ++k)
+	{
+		if (stop.stop_requested() || (deadline != Deadline::max() && std::chrono::steady_clock::now() > deadline))
+			return false;
+		if (progress && k % ATTEMPTS_DISPLAY_INCREMENT == 0)
+			progress(k, 2 * total);
+
+		const Step& step = steps[k];
+		for (const auto& [boundary, completion] : completions[k])
+		{
+			const std::uint64_t carried = carry(step, boundary);
+			const auto [begin, end] = std::ranges::equal_range(step.choices, boundary & step.closing_mask, {}, &Choice::required);
+			for (auto choice = begin; choice != end; ++choice)
+				completions[k + 1].emplace(carried | choice->opened, 0.0);
+		}
+		if ((int)completions[k + 1].size() > TRANSFER_MAX_STATES)
+			return false;
+	}
+
+	/// Then go backwards, where each boundary has as many completions as all the boundaries it leads to put together, or one after the last step.
+	for (auto& [boundary, completion] : completions[total])
+		completion = 1.0;
+
+	for (int k = total - 1; k >= 0; --k)
+	{
+		if (stop.stop_requested() || (deadline != Deadline::max() && std::chrono::steady_clock::now() > deadline))
+			return false;
+		if (progress && k % ATTEMPTS_DISPLAY_INCREMENT == 0)
+			progress(2 * total - k, 2 * total);
+
+		const Step& step = steps[k];
+		double largest = 0.0;
+		for (auto& [boundary, completion] : completions[k])
+		{
+			const std::uint64_t carried = carry(step, boundary);
+			const auto [begin, end] = std::ranges::equal_range(step.choices, boundary & step.closing_mask, {}, &Choice::required);
+			for (auto choice = begin; choice != end; ++choice)
+				completion += completions[k + 1].at(carried | choice->opened);
+			largest = std::max(largest, completion);
+		}
+
+		if (largest > 0.0)
+		{
+			for (auto& [boundary, completion] : completions[k])
+				completion /= largest;
+			log10_scale += std::log10(largest);
+		}
+	}
+	return true;
+}
+
+double StripSampler::log10_solutions() const
+{
+	return std::log10(completions[0].at(0)) + log10_scale;
+}
+
+std::optional<std::vector<std::size_t>> StripSampler::sample(Rng& rng) const
+{
+	if (completions.empty() || completions[0].at(0) == 0.0)
+		return std::nullopt;
+
+	std::vector<std::size_t> values(steps.size());
+	std::vector<double> totals;
+	std::uint64_t boundary = 0;
+	for (std::size_t k = 0; k < steps.size(); ++k)
+	{
+		const Step& step = steps[k];
+		const std::uint64_t carried = carry(step, boundary);
+		const auto [begin, end] = std::ranges::equal_range(step.choices, boundary & step.closing_mask, {}, &Choice::required);
+
+		totals.clear();
+		double total = 0.0;
+		for (auto choice = begin; choice != end; ++choice)
+			totals.push_back(total += completions[k + 1].at(carried | choice->opened));
+
+		/// Each choice is taken with a chance in proportion to its weight, by finding where a uniform draw falls among the running totals.
+		const double drawn = rng.unit() * total;
+		const auto chosen = begin + std::min<std::ptrdiff_t>(std::ranges::upper_bound(totals, drawn) - totals.begin(), end - begin - 1);
+		values[step.variable] = chosen->glyph;
+		boundary = carried | chosen->opened;
+	}
+	return values;
+}
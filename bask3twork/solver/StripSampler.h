@@ -0,0 +1,81 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <unordered_map>
+#include <vector>
+#include "Forward.h"
+#include "pure/GlyphSet.h"
+
+/** Draws a solution of a \c Problem uniformly at random from all of its solutions, by counting them with a transfer matrix.
+ *
+ * The variables are taken one at a time along the longer side of the selection. At each step, the only thing the variables still to come need to know
+ * about the ones already taken is the \c Connection on each open edge between the two, which for a strip a few tiles wide is only a few connections.
+ * Counting backwards from the last step gives, for every such boundary, the number of ways to complete the knot from it, so each glyph can then be drawn
+ * with probability in proportion to the number of knots it leads to. This never fails when a solution exists, and every solution is equally likely,
+ * unlike choosing each glyph uniformly from those which fit locally, which favours the knots with fewer options along the way.
+ *
+ * The number of boundaries grows exponentially with the width of the strip, so counting gives up once a step has more than \c TRANSFER_MAX_STATES of them.
+ */
+class StripSampler
+{
+public:
+	/// \param domains The domains to draw glyphs from, usually those of a \c Propagator after Propagator::propagate() has succeeded
+	StripSampler(const Problem& problem, const std::vector<GlyphSet>& domains);
+
+	/// Called with the number of steps counted so far, and the total
+	using Progress = std::function<void(int steps, int total)>;
+
+	using Deadline = std::chrono::steady_clock::time_point;
+
+	bool count(const Progress& progress = {}, std::stop_token stop = {}, Deadline deadline = Deadline::max());
+	std::optional<std::vector<std::size_t>> sample(Rng& rng) const;
+	double log10_solutions() const;
+
+private:
+	/// One glyph for the variable of a step, with the connections it needs on the edges it closes, and the connections it leaves on the edges it opens
+	struct Choice
+	{
+		std::uint64_t required; ///< The connections on the closing edges, packed as in a boundary
+		std::uint64_t opened;   ///< The connections on the opening edges, packed as in the next boundary
+		std::size_t glyph;
+	};
+
+	/// One variable, with how it changes the boundary of open edges
+	struct Step
+	{
+		int variable;
+		std::uint64_t closing_mask = 0;                  ///< The bits of the boundary belonging to edges which this variable closes
+		std::vector<std::pair<int, int>> carried;        ///< The slots of the edges which stay open, in this boundary and in the next
+		std::vector<Choice> choices;                     ///< Every glyph of the variable, ordered by \c Choice::required
+	};
+
+	std::vector<Step> steps;
+	bool too_wide = false; ///< Whether some boundary has more open edges than fit in a key
+
+	/// For each step, and after the last, the number of ways to complete the knot from each boundary reached there, scaled so that the largest is \c 1
+	std::vector<std::unordered_map<std::uint64_t, double>> completions;
+	double log10_scale = 0.0; ///< The base ten logarithm of the product of every factor which the counts were divided by when scaling them
+
+	std::uint64_t carry(const Step& step, std::uint64_t boundary) const;
+};
+
+/* StripSampler */
+/** \fn StripSampler::count(const Progress& progress, std::stop_token stop, Deadline deadline)
+ * Find every boundary which can be reached at each step, then count the ways to complete the knot from each of them, working back from the last step.
+ * Only the counts at the same step are ever compared, so each step is scaled on its own, and no count overflows however long the strip is.
+ * \return Whether counting finished, which it does not if the strip is too wide, \c stop is requested, or \c deadline passes
+ */
+/** \fn StripSampler::sample(Rng& rng) const
+ * Draw each glyph in turn, in proportion to the number of ways to complete the knot after it. Only call this after StripSampler::count() has succeeded.
+ * \return The glyph for each variable, or \c std::nullopt if there is no solution at all
+ */
+/** \fn StripSampler::log10_solutions() const
+ * The base ten logarithm of the number of solutions, which is minus infinity if there are none. Only call this after StripSampler::count() has succeeded.
+ * The number itself can be too large for a \c double, such as for a long strip, and even when it is not, it is only exact up to rounding.
+ */
+/** \fn StripSampler::carry(const Step& step, std::uint64_t boundary) const
+ * The part of the next boundary which comes from the edges that stay open through \c step
+ */
@@ -0,0 +1,101 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "pure/GlyphSet.h"
+
+/** The variables of a \c Problem ordered by how many glyphs they have left, fewest first, with ties going to the earliest variable.
+ *
+ * This is a binary heap which also records where each variable is within it, so that a variable whose domain has shrunk
+ * can be moved up to its new place straight away, rather than the whole heap being searched or rebuilt.
+ * Domains only ever shrink while filling, so that is the only update it needs.
+ */
+class VariableHeap
+{
+public:
+	/// Fills the heap with every variable, keyed by the size of its domain in \c domains.
+	/// The storage from any earlier use is reused, so this makes no allocations once it has held as many variables before.
+	void build(const std::vector<GlyphSet>& domains)
+	{
+		const int count = (int)domains.size();
+		heap.resize(count);
+		positions.resize(count);
+		keys.resize(count);
+		for (int variable = 0; variable < count; ++variable)
+		{
+			heap[variable] = variable;
+			positions[variable] = variable;
+			keys[variable] = (int)domains[variable].count();
+		}
+		for (int position = count / 2 - 1; position >= 0; --position)
+			sift_down(position);
+	}
+
+	bool empty() const { return heap.empty(); }
+
+	/// Removes and returns the variable with the fewest glyphs left
+	int pop()
+	{
+		const int top = heap.front();
+		move(heap.back(), 0);
+		heap.pop_back();
+		positions[top] = -1;
+		if (!heap.empty())
+			sift_down(0);
+		return top;
+	}
+
+	/// Records that \c variable now has only \c count glyphs left, if it is still in the heap
+	void decrease(int variable, int count)
+	{
+		if (variable >= (int)positions.size() || positions[variable] == -1)
+			return;
+		keys[variable] = count;
+		sift_up(positions[variable]);
+	}
+
+private:
+	std::vector<int> heap;      ///< The variables, where each one comes before the two at twice its position plus one and plus two
+	std::vector<int> positions; ///< The position of each variable in \c heap, or \c -1 once it has been popped
+	std::vector<int> keys;      ///< The number of glyphs left for each variable
+
+	bool before(int a, int b) const { return std::pair(keys[a], a) < std::pair(keys[b], b); }
+
+	void move(int variable, int position)
+	{
+		heap[position] = variable;
+		positions[variable] = position;
+	}
+
+	void sift_up(int position)
+	{
+		const int variable = heap[position];
+		while (position > 0)
+		{
+			const int parent = (position - 1) / 2;
+			if (!before(variable, heap[parent]))
+				break;
+			move(heap[parent], position);
+			position = parent;
+		}
+		move(variable, position);
+	}
+
+	void sift_down(int position)
+	{
+		const int variable = heap[position];
+		const int count = (int)heap.size();
+		while (true)
+		{
+			int child = 2 * position + 1;
+			if (child >= count)
+				break;
+			if (child + 1 < count && before(heap[child + 1], heap[child]))
+				++child;
+			if (!before(heap[child], variable))
+				break;
+			move(heap[child], position);
+			position = child;
+		}
+		move(variable, position);
+	}
+};